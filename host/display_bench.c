@@ -0,0 +1,90 @@
+// Cost of a display update as the strips grow: host/CMakeLists.txt builds this
+// once per DISPLAY_* layout (display_bench_<LEDs per strip>) and each binary
+// times, with the firmware's framebuffer.c, scoreboard.c and anim.c:
+//
+//   draw     scoreboard_draw(), staging both strips
+//   present  framebuffer_present() of a changed frame: brightness, gamma,
+//            current limiter, change check and one transmit per strip (the
+//            host RMT stub only copies the bytes)
+//   anim     anim_frame() of a crossfade on both strips
+//
+// and prints the time the frame takes on the wire, which on the board bounds
+// how fast the strips can be refreshed. Everything is linear in the LED count.
+//
+// Usage: display_bench_<leds> [iterations]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "anim.h"
+#include "framebuffer.h"
+#include "rules.h"
+#include "scoreboard.h"
+
+#define DEFAULT_ITERATIONS 20000
+#define WS2812_BIT_NS 1250
+#define WS2812_RESET_US 50
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+
+    rmt_channel_handle_t strips[STRIP_COUNT];
+    rmt_encoder_handle_t encoders[STRIP_COUNT];
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        rmt_tx_channel_config_t tx_chan_config = {
+            .gpio_num = strip == STRIP_TEAM_1 ? 13 : 12,
+            .mem_block_symbols = 64,
+            .resolution_hz = 10000000,
+            .trans_queue_depth = 4,
+        };
+        ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_config, &strips[strip]));
+        ESP_ERROR_CHECK(rmt_enable(strips[strip]));
+        ESP_ERROR_CHECK(host_rmt_new_encoder(&encoders[strip]));
+    }
+    const gpio_num_t pins[STRIP_COUNT] = {13, 12};
+    framebuffer_init(strips, encoders, pins);
+    framebuffer_set_brightness(STRIP_TEAM_1, 160);
+    framebuffer_set_brightness(STRIP_TEAM_2, 160);
+    framebuffer_set_current_limit(1200);
+
+    const rules_config_t *rules = &rules_formats[RULES_FORMAT_CLASSIC];
+    static frame_t frames[2], out;
+    uint64_t draw_ns = 0, present_ns = 0, anim_ns = 0;
+    uint32_t sent = 0;
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        // Every update changes both strips, so nothing is skipped as unchanged
+        rules_state_t match = {.score = {i % 10, 9 - i % 10}, .sets = {i & 1, 0}};
+        uint64_t start = now_ns();
+        scoreboard_draw(rules, &match);
+        draw_ns += now_ns() - start;
+
+        framebuffer_snapshot(&frames[i & 1]);
+        start = now_ns();
+        sent += __builtin_popcount(framebuffer_present(&frames[i & 1]));
+        present_ns += now_ns() - start;
+
+        anim_t fade = {.kind = ANIM_CROSSFADE, .strips = ANIM_ALL_STRIPS, .duration_ms = 300};
+        start = now_ns();
+        anim_frame(&fade, &frames[(i & 1) ^ 1], &frames[i & 1], i % 300, &out);
+        anim_ns += now_ns() - start;
+    }
+
+    uint32_t wire_us = LED_NUMBERS * 24 * WS2812_BIT_NS / 1000 + WS2812_RESET_US;
+    printf("%4d LEDs per strip (%d digits x %d LEDs per segment + %d), %u updates, %lu strips sent\n", LED_NUMBERS,
+           DISPLAY_DIGITS, DISPLAY_SEGMENT_PIXELS, DISPLAY_INDICATORS, iterations, (unsigned long)sent);
+    printf("  draw %8.0fns  present %8.0fns  anim %8.0fns  wire %6luus (strips in parallel)\n",
+           (double)draw_ns / iterations, (double)present_ns / iterations, (double)anim_ns / iterations,
+           (unsigned long)wire_us);
+    return 0;
+}
@@ -0,0 +1,342 @@
+// Terminal simulator of the scoreboard: main/framebuffer.c, scoreboard.c,
+// anim.c and rules.c run unchanged on top of the RMT stub in host/stubs and a
+// synchronous render.h (render_host.c), and every frame "transmitted" is drawn
+// as 7-segment digits laid out as in displayOrder.png, for whatever
+// DISPLAY_* layout display.h was built with.
+//
+// Keys: 1 / 2 point for side 1 / side 2, u undo the last point, r restart the
+// match, f restart with the next match format, q quit.
+//
+// Every point is stamped like score_point() in main.c does, and must light
+// the strips with a frame that differs from the one before it (the photon).
+// Between keys the render is idle, so the strip data pins must be held.
+//
+// Usage: display_sim                   interactive, in a terminal
+//        display_sim --script 1121r2   plays the keys without delays, prints
+//                                      the last frame of every key and the
+//                                      transmission counts; exit status 1 when
+//                                      a point had no photon or a pin was not
+//                                      held
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "framebuffer.h"
+#include "history.h"
+#include "render.h"
+#include "render_host.h"
+#include "rules.h"
+#include "scoreboard.h"
+
+#define SEG DISPLAY_SEGMENT_PIXELS
+#define GRID_ROWS (2 * SEG + 3)
+#define GRID_COLS (SEG + 2)
+#define NO_LED -1
+
+// LED index at a cell of a digit, following the clockwise wiring of display.h;
+// indicator 0 (the set LED) sits in the top-left corner of the first digit
+static int grid_led(int digit, int row, int col)
+{
+    int base = digit * DIGIT_LEDS;
+    bool left = col == 0, right = col == SEG + 1, inside = !left && !right;
+    if (row == 0 && left)
+    {
+        return digit == 0 && DISPLAY_INDICATORS ? LED_INDICATOR(0) : NO_LED;
+    }
+    if (row == 0 && inside)
+    {
+        return base + 0 * SEG + col - 1; // TOP, left to right
+    }
+    if (row >= 1 && row <= SEG && right)
+    {
+        return base + 1 * SEG + row - 1; // TOP_RIGHT, downwards
+    }
+    if (row >= SEG + 2 && row <= 2 * SEG + 1 && right)
+    {
+        return base + 2 * SEG + row - SEG - 2; // BOT_RIGHT, downwards
+    }
+    if (row == 2 * SEG + 2 && inside)
+    {
+        return base + 3 * SEG + SEG - col; // BOT, right to left
+    }
+    if (row >= SEG + 2 && row <= 2 * SEG + 1 && left)
+    {
+        return base + 4 * SEG + 2 * SEG + 1 - row; // BOT_LEFT, upwards
+    }
+    if (row >= 1 && row <= SEG && left)
+    {
+        return base + 5 * SEG + SEG - row; // TOP_LEFT, upwards
+    }
+    if (row == SEG + 1 && inside)
+    {
+        return base + 6 * SEG + col - 1; // MID, left to right
+    }
+    return NO_LED;
+}
+
+static rmt_channel_handle_t strips[STRIP_COUNT];
+static rmt_encoder_handle_t encoders[STRIP_COUNT];
+static uint8_t format = RULES_FORMAT_CLASSIC;
+static rules_state_t match;
+static history_t history;
+static bool scripted = false;
+static struct termios saved_termios;
+static char status[256] = "";
+static uint32_t photon_failures = 0;
+static uint32_t pin_failures = 0;
+
+static void draw_led(const uint8_t *frame, size_t bytes, int led)
+{
+    if (led == NO_LED)
+    {
+        printf("  ");
+        return;
+    }
+    if ((size_t)(led * 3 + 2) >= bytes)
+    {
+        printf("??");
+        return;
+    }
+    // WS2812 wire order is G, R, B
+    uint8_t green = frame[led * 3], red = frame[led * 3 + 1], blue = frame[led * 3 + 2];
+    if (!red && !green && !blue)
+    {
+        printf("\x1b[2m::\x1b[0m");
+        return;
+    }
+    printf("\x1b[38;2;%u;%u;%um\xe2\x96\x88\xe2\x96\x88\x1b[0m", red, green, blue);
+}
+
+// Draws what the strips last received, not the staged pixels
+static void draw(void)
+{
+    if (!scripted)
+    {
+        printf("\x1b[H\x1b[2J");
+    }
+    int strip_width = DISPLAY_DIGITS * (GRID_COLS + 1) * 2 + 10;
+    printf("   side 1 (GPIO %d)%*sside 2 (GPIO %d)\n", host_rmt_gpio(strips[STRIP_TEAM_1]), strip_width - 15, "",
+           host_rmt_gpio(strips[STRIP_TEAM_2]));
+    for (int row = 0; row < GRID_ROWS; row++)
+    {
+        printf("   ");
+        for (int strip = 0; strip < STRIP_COUNT; strip++)
+        {
+            size_t bytes;
+            const uint8_t *frame = host_rmt_frame(strips[strip], &bytes);
+            for (int digit = 0; digit < DISPLAY_DIGITS; digit++)
+            {
+                for (int col = 0; col < GRID_COLS; col++)
+                {
+                    draw_led(frame, bytes, grid_led(digit, row, col));
+                }
+                printf("  ");
+            }
+            printf("          ");
+        }
+        printf("\n");
+    }
+    for (int indicator = 1; indicator < DISPLAY_INDICATORS; indicator++)
+    {
+        printf("   indicator %d:", indicator);
+        for (int strip = 0; strip < STRIP_COUNT; strip++)
+        {
+            size_t bytes;
+            const uint8_t *frame = host_rmt_frame(strips[strip], &bytes);
+            printf("  ");
+            draw_led(frame, bytes, LED_INDICATOR(indicator));
+        }
+        printf("\n");
+    }
+    printf("\n%s\n", status);
+    if (!scripted)
+    {
+        printf("[1] side 1  [2] side 2  [u] undo  [r] restart  [f] format  [q] quit\n");
+    }
+    fflush(stdout);
+}
+
+static void on_transmit(rmt_channel_handle_t channel, void *arg)
+{
+    (void)channel;
+    (void)arg;
+    if (!scripted)
+    {
+        draw();
+    }
+}
+
+static void start_game(void)
+{
+    match = rules_initial();
+    history_start(&history, &match);
+    scoreboard_show(&rules_formats[format], &match, 0, 0);
+}
+
+static uint32_t transmissions(void)
+{
+    uint32_t total = 0;
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        total += host_rmt_transmissions(strips[strip]);
+    }
+    return total;
+}
+
+// Returns false on quit
+static bool handle_key(char key, uint32_t *events)
+{
+    uint32_t before = transmissions();
+    if (key == 'q')
+    {
+        return false;
+    }
+    if (key == 'r')
+    {
+        start_game();
+        snprintf(status, sizeof(status), "restart: %lu frames", (unsigned long)(transmissions() - before));
+    }
+    else if (key == 'f')
+    {
+        format = (format + 1) % RULES_FORMAT_COUNT;
+        history_reset(&history);
+        scoreboard_announce(format + 1);
+        start_game();
+        snprintf(status, sizeof(status), "format %u: %s, %lu frames", format + 1, rules_formats[format].name,
+                 (unsigned long)(transmissions() - before));
+    }
+    else if (key == 'u')
+    {
+        bool undone = history_undo(&history, &match);
+        if (undone)
+        {
+            scoreboard_show(&rules_formats[format], &match, 0, 0);
+        }
+        snprintf(status, sizeof(status), "undo: %s %u-%u sets %u-%u, %lu more possible", undone ? "back to" : "nothing to undo,",
+                 match.score[RULES_TEAM_BLUE], match.score[RULES_TEAM_RED], match.sets[RULES_TEAM_BLUE],
+                 match.sets[RULES_TEAM_RED], (unsigned long)history_undoable(&history));
+    }
+    else if (key == '1' || key == '2')
+    {
+        uint8_t event = key == '1' ? RULES_EVENT_SIDE_1 : RULES_EVENT_SIDE_2;
+        rules_result_t result = rules_apply(&rules_formats[format], match, event);
+        match = result.state;
+        history_push(&history, &match, event);
+        uint32_t photons_before, unchanged_before, photons, unchanged;
+        render_host_photons(&photons_before, &unchanged_before);
+        render_stamp(1);
+        scoreboard_show(&rules_formats[format], &match, result.effects, result.team);
+        render_host_photons(&photons, &unchanged);
+        if (photons != photons_before + 1 || unchanged != unchanged_before)
+        {
+            photon_failures++;
+            fprintf(stderr, "FAIL: point %lu lit %lu frames, %lu of them unchanged\n", (unsigned long)(*events + 1),
+                    (unsigned long)(photons - photons_before), (unsigned long)(unchanged - unchanged_before));
+        }
+        render_stats_t render_stats;
+        render_get_stats(&render_stats);
+        snprintf(status, sizeof(status), "side %c: %s %u-%u sets %u-%u, %lu frames (sent %lu, skipped %lu), photon %luus, anim %luns max %luns", key,
+                 result.effects & RULES_EFFECT_END ? "END" : "SCORE", match.score[RULES_TEAM_BLUE],
+                 match.score[RULES_TEAM_RED], match.sets[RULES_TEAM_BLUE], match.sets[RULES_TEAM_RED],
+                 (unsigned long)(transmissions() - before), (unsigned long)framebuffer_frames_sent(),
+                 (unsigned long)framebuffer_frames_skipped(), (unsigned long)render_stats.last_latency_us,
+                 (unsigned long)render_stats.last_anim_ns,
+                 (unsigned long)render_stats.max_anim_ns);
+        (*events)++;
+    }
+    else
+    {
+        return true;
+    }
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        if (!host_gpio_held(host_rmt_gpio(strips[strip])))
+        {
+            pin_failures++;
+            fprintf(stderr, "FAIL: GPIO %d not held after key %c\n", host_rmt_gpio(strips[strip]), key);
+        }
+    }
+    draw();
+    return true;
+}
+
+static void restore_terminal(void)
+{
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+}
+
+int main(int argc, char **argv)
+{
+    const char *script = NULL;
+    if (argc == 3 && strcmp(argv[1], "--script") == 0)
+    {
+        script = argv[2];
+        scripted = true;
+    }
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [--script KEYS]\n", argv[0]);
+        return 2;
+    }
+
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        rmt_tx_channel_config_t tx_chan_config = {
+            .gpio_num = strip == STRIP_TEAM_1 ? 13 : 12,
+            .mem_block_symbols = 64,
+            .resolution_hz = 10000000,
+            .trans_queue_depth = 4,
+        };
+        ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_config, &strips[strip]));
+        ESP_ERROR_CHECK(rmt_enable(strips[strip]));
+        ESP_ERROR_CHECK(host_rmt_new_encoder(&encoders[strip]));
+    }
+    const gpio_num_t pins[STRIP_COUNT] = {13, 12};
+    framebuffer_init(strips, encoders, pins);
+    render_init(60);
+    render_host_set_realtime(!scripted);
+    host_rmt_set_transmit_hook(on_transmit, NULL);
+
+    if (!scripted)
+    {
+        struct termios raw;
+        tcgetattr(STDIN_FILENO, &saved_termios);
+        atexit(restore_terminal);
+        raw = saved_termios;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+
+    start_game();
+    snprintf(status, sizeof(status), "start: %lu frames", (unsigned long)transmissions());
+    draw();
+
+    uint32_t events = 0;
+    if (scripted)
+    {
+        for (const char *key = script; *key && handle_key(*key, &events); key++)
+        {
+        }
+    }
+    else
+    {
+        char key;
+        while (read(STDIN_FILENO, &key, 1) == 1 && handle_key(key, &events))
+        {
+        }
+    }
+
+    printf("%lu point events, %lu transmissions, %lu frames skipped as unchanged\n", (unsigned long)events,
+           (unsigned long)transmissions(), (unsigned long)framebuffer_frames_skipped());
+    if (photon_failures || pin_failures)
+    {
+        printf("%lu points without a photon, %lu strip pins left free while idle\n", (unsigned long)photon_failures,
+               (unsigned long)pin_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+// Decodes the "EVLOG ..." lines printed by the 'log' console command (see
+// main/eventlog.c) back into text, oldest first. Other lines are ignored, so a
+// whole serial capture can be piped in.
+//
+// Usage: log_decode < capture.txt
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "eventlog.h"
+
+#define MAX_RECORDS 4096
+
+static int by_seq(const void *a, const void *b)
+{
+    uint32_t seq_a = ((const eventlog_record_t *)a)->seq, seq_b = ((const eventlog_record_t *)b)->seq;
+    return (seq_a > seq_b) - (seq_a < seq_b);
+}
+
+int main(void)
+{
+    static eventlog_record_t records[MAX_RECORDS];
+    size_t count = 0;
+    char line[256];
+
+    while (fgets(line, sizeof(line), stdin) && count < MAX_RECORDS)
+    {
+        unsigned long seq, time_ms, arg1;
+        unsigned int id, arg0;
+        const char *start = strstr(line, "EVLOG ");
+        if (!start || sscanf(start, "EVLOG %8lx%8lx%4x%4x%8lx", &seq, &time_ms, &id, &arg0, &arg1) != 5)
+        {
+            continue;
+        }
+        records[count++] = (eventlog_record_t){
+            .seq = seq,
+            .time_ms = time_ms,
+            .id = id,
+            .arg0 = arg0,
+            .arg1 = arg1,
+        };
+    }
+
+    qsort(records, count, sizeof(records[0]), by_seq);
+    for (size_t i = 0; i < count; i++)
+    {
+        char text[160];
+        eventlog_format(&records[i], text, sizeof(text));
+        printf("%s\n", text);
+    }
+    return count ? 0 : 1;
+}
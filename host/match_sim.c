@@ -0,0 +1,465 @@
+// Host-side match simulator for the rules in main/rules.c.
+//
+// 1. Walks, for every format in rules_formats, every state reachable from the
+//    start of a match with both buttons, checking the invariants below; the
+//    classic format is also compared transition by transition against a port
+//    of the original BTN 1 / BTN 2 branches of debounce_btn_team_task.
+// 2. Plays random button sequences and reports events/sec for the table
+//    engine in each format and for the original branches, as a baseline for
+//    rewrites.
+//
+// 3. Checks that undo in main/history.c stops at the start of a match, after
+//    a restart and after a format change.
+//
+// Usage: match_sim [random_events]   (exit status 1 on any violation)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "history.h"
+#include "rules.h"
+
+#define STATE_KEYS (1 << 12)
+#define DEFAULT_RANDOM_EVENTS 20000000ULL
+
+static unsigned violations = 0;
+static const rules_config_t *rules = &rules_formats[RULES_FORMAT_CLASSIC];
+
+#define CHECK(cond, state, event, ...)                                                       \
+    do                                                                                       \
+    {                                                                                        \
+        if (!(cond))                                                                         \
+        {                                                                                    \
+            if (violations++ < 20)                                                           \
+            {                                                                                \
+                printf("VIOLATION [%s %u-%u sets %u-%u, side %d] ", rules->name,            \
+                       (state).score[0], (state).score[1], (state).sets[0], (state).sets[1], \
+                       (event) + 1);                                                         \
+                printf(__VA_ARGS__);                                                         \
+                printf("\n");                                                                \
+            }                                                                                \
+        }                                                                                    \
+    } while (0)
+
+// The scoring branches as they were in main.c before the rules engine, with
+// GPIO/LED/buzzer calls removed. Returns true where end_game() was called.
+typedef struct
+{
+    uint8_t scoreboard_team_1, scoreboard_team_2;
+    bool set_blue_team, set_red_team, set_final_blue_team, set_final_red_team;
+} legacy_state_t;
+
+__attribute__((noinline)) static bool legacy_apply(legacy_state_t *g, int btn)
+{
+    if (btn == RULES_EVENT_SIDE_1)
+    {
+        if (g->set_blue_team || g->set_red_team)
+        {
+            if (g->set_final_red_team)
+            {
+                if (g->set_final_blue_team && g->scoreboard_team_1 == 1)
+                {
+                    g->scoreboard_team_1 = 0;
+                    g->scoreboard_team_2 = 0;
+                }
+                else
+                {
+                    g->scoreboard_team_2++;
+                    if (g->set_final_blue_team && g->scoreboard_team_1 == 1)
+                    {
+                        g->scoreboard_team_1 = 0;
+                        g->scoreboard_team_2 = 0;
+                    }
+                    else if (!g->set_final_blue_team || (g->scoreboard_team_1 == 0 && g->scoreboard_team_2 == 2))
+                    {
+                        memset(g, 0, sizeof(*g));
+                        return true;
+                    }
+                }
+            }
+            else if (g->scoreboard_team_2 == 9)
+            {
+                g->scoreboard_team_2 = 0;
+                if (g->set_red_team)
+                {
+                    g->set_final_red_team = true;
+                    if (g->set_final_blue_team)
+                    {
+                        g->scoreboard_team_1 = 0;
+                        g->scoreboard_team_2 = 0;
+                    }
+                }
+                else
+                {
+                    g->set_red_team = true;
+                }
+            }
+            else
+            {
+                g->scoreboard_team_2++;
+            }
+        }
+        else if (g->scoreboard_team_1 == 9)
+        {
+            g->scoreboard_team_1 = 0;
+            g->set_blue_team = true;
+        }
+        else
+        {
+            g->scoreboard_team_1++;
+        }
+    }
+    else
+    {
+        if (g->set_blue_team || g->set_red_team)
+        {
+            if (g->set_final_blue_team)
+            {
+                if (g->set_final_red_team && g->scoreboard_team_2 == 1)
+                {
+                    g->scoreboard_team_1 = 0;
+                    g->scoreboard_team_2 = 0;
+                }
+                else
+                {
+                    g->scoreboard_team_1++;
+                    if (g->set_final_red_team && g->scoreboard_team_2 == 1)
+                    {
+                        g->scoreboard_team_1 = 0;
+                        g->scoreboard_team_2 = 0;
+                    }
+                    else if (!g->set_final_red_team || (g->scoreboard_team_2 == 0 && g->scoreboard_team_1 == 2))
+                    {
+                        memset(g, 0, sizeof(*g));
+                        return true;
+                    }
+                }
+            }
+            else if (g->scoreboard_team_1 == 9)
+            {
+                g->scoreboard_team_1 = 0;
+                if (g->set_blue_team)
+                {
+                    g->set_final_blue_team = true;
+                    if (g->set_final_red_team)
+                    {
+                        g->scoreboard_team_1 = 0;
+                        g->scoreboard_team_2 = 0;
+                    }
+                }
+                else
+                {
+                    g->set_blue_team = true;
+                }
+            }
+            else
+            {
+                g->scoreboard_team_1++;
+            }
+        }
+        else if (g->scoreboard_team_2 == 9)
+        {
+            g->scoreboard_team_2 = 0;
+            g->set_red_team = true;
+        }
+        else
+        {
+            g->scoreboard_team_2++;
+        }
+    }
+    return false;
+}
+
+static legacy_state_t to_legacy(const rules_state_t *state)
+{
+    return (legacy_state_t){
+        .scoreboard_team_1 = state->score[RULES_TEAM_BLUE],
+        .scoreboard_team_2 = state->score[RULES_TEAM_RED],
+        .set_blue_team = state->sets[RULES_TEAM_BLUE] >= 1,
+        .set_red_team = state->sets[RULES_TEAM_RED] >= 1,
+        .set_final_blue_team = state->sets[RULES_TEAM_BLUE] >= rules_formats[RULES_FORMAT_CLASSIC].sets_final,
+        .set_final_red_team = state->sets[RULES_TEAM_RED] >= rules_formats[RULES_FORMAT_CLASSIC].sets_final,
+    };
+}
+
+static rules_state_t mirror(const rules_state_t *state)
+{
+    return (rules_state_t){
+        .score = {state->score[RULES_TEAM_RED], state->score[RULES_TEAM_BLUE]},
+        .sets = {state->sets[RULES_TEAM_RED], state->sets[RULES_TEAM_BLUE]},
+    };
+}
+
+static bool swapped(const rules_state_t *state)
+{
+    return rules_side_team(rules, state, RULES_SIDE_1) != RULES_TEAM_BLUE;
+}
+
+static void check_transition(const rules_state_t *state, uint8_t event, const rules_result_t *result)
+{
+    const rules_state_t *next = &result->state;
+
+    for (int team = 0; team < RULES_TEAM_COUNT; team++)
+    {
+        CHECK(next->score[team] <= rules->set_point, *state, event, "score %u above the set limit", next->score[team]);
+        CHECK(next->sets[team] <= rules->sets_final, *state, event, "%u sets won", next->sets[team]);
+    }
+    CHECK(rules_valid(rules, next), *state, event, "rules_valid rejects a reachable state");
+
+    // The swap effect follows the sides, and only a team on final can end the match
+    bool swap_expected = swapped(state) != swapped(next) && !(result->effects & RULES_EFFECT_END);
+    CHECK(!!(result->effects & RULES_EFFECT_SWAP) == swap_expected, *state, event, "swap effect %s",
+          swap_expected ? "missing" : "unexpected");
+    CHECK(!(result->effects & RULES_EFFECT_END) || state->sets[result->team] >= rules->sets_final, *state, event,
+          "match ended without a final");
+    CHECK(!(result->effects & RULES_EFFECT_END) || memcmp(next, &(rules_state_t){0}, sizeof(*next)) == 0,
+          *state, event, "end did not reset the match");
+
+    // Whatever team plays on the pressed side is the one credited
+    CHECK(result->team == rules_side_team(rules, state, event), *state, event, "point credited to the wrong team");
+
+    // Blue and red follow the same rules: mirroring the teams mirrors the result
+    rules_state_t mirrored = mirror(state);
+    rules_result_t mirrored_result = rules_apply(rules, mirrored, event ^ 1);
+    rules_state_t expected = mirror(next);
+    CHECK(memcmp(&mirrored_result.state, &expected, sizeof(expected)) == 0 && mirrored_result.effects == result->effects,
+          *state, event, "asymmetric between blue and red");
+
+    // Same outcome as the original branches
+    if (rules != &rules_formats[RULES_FORMAT_CLASSIC])
+    {
+        return;
+    }
+    legacy_state_t legacy = to_legacy(state);
+    bool legacy_end = legacy_apply(&legacy, event);
+    legacy_state_t legacy_next = to_legacy(next);
+    CHECK(memcmp(&legacy, &legacy_next, sizeof(legacy)) == 0 && legacy_end == !!(result->effects & RULES_EFFECT_END),
+          *state, event, "differs from the original branches");
+}
+
+// Breadth-first walk of every reachable state; then a backwards walk proving
+// that end_game is reachable from each of them.
+static void explore(void)
+{
+    static bool reached[STATE_KEYS], can_end[STATE_KEYS];
+    static uint16_t queue[STATE_KEYS];
+    static uint16_t next_key[STATE_KEYS][RULES_EVENT_COUNT];
+    static bool ends[STATE_KEYS][RULES_EVENT_COUNT];
+    unsigned head = 0, tail = 0, transitions = 0;
+    memset(reached, 0, sizeof(reached));
+    memset(can_end, 0, sizeof(can_end));
+
+    rules_state_t start = rules_initial();
+    reached[rules_pack(&start)] = true;
+    queue[tail++] = rules_pack(&start);
+
+    while (head < tail)
+    {
+        uint16_t key = queue[head++];
+        rules_state_t state = rules_unpack(key);
+        for (uint8_t event = 0; event < RULES_EVENT_COUNT; event++)
+        {
+            rules_result_t result = rules_apply(rules, state, event);
+            check_transition(&state, event, &result);
+            transitions++;
+
+            uint16_t next = rules_pack(&result.state);
+            next_key[key][event] = next;
+            ends[key][event] = result.effects & RULES_EFFECT_END;
+            if (!reached[next])
+            {
+                reached[next] = true;
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (unsigned i = 0; i < tail; i++)
+        {
+            uint16_t key = queue[i];
+            if (can_end[key])
+            {
+                continue;
+            }
+            for (uint8_t event = 0; event < RULES_EVENT_COUNT; event++)
+            {
+                if (ends[key][event] || can_end[next_key[key][event]])
+                {
+                    can_end[key] = changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    unsigned dead_ends = 0;
+    for (unsigned i = 0; i < tail; i++)
+    {
+        if (!can_end[queue[i]])
+        {
+            rules_state_t state = rules_unpack(queue[i]);
+            CHECK(false, state, 0, "end_game is unreachable from here");
+            dead_ends++;
+        }
+    }
+
+    printf("exhaustive %-8s %4u states reachable, %u transitions checked, %u dead ends\n", rules->name, tail,
+           transitions, dead_ends);
+}
+
+static inline uint64_t xorshift64(uint64_t *seed)
+{
+    uint64_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return *seed = x;
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Random rallies in the current format: checks the per-match invariants, returns the time taken
+static double random_engine(unsigned long long events, unsigned long long *matches)
+{
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    rules_state_t state = rules_initial();
+    unsigned swaps = 0;
+    uint64_t bits = 0;
+    *matches = 0;
+
+    double start = now_s();
+    for (unsigned long long i = 0; i < events; i++)
+    {
+        if ((i & 63) == 0)
+        {
+            bits = xorshift64(&seed);
+        }
+        rules_result_t result = rules_apply(rules, state, bits & 1);
+        bits >>= 1;
+        swaps += !!(result.effects & RULES_EFFECT_SWAP);
+        if (result.effects & RULES_EFFECT_END)
+        {
+            CHECK(rules->swap != RULES_SWAP_FIRST_SET || swaps == 1, state, 0, "%u side swaps in one match", swaps);
+            swaps = 0;
+            (*matches)++;
+        }
+        state = result.state;
+    }
+    return now_s() - start;
+}
+
+// Same rallies through the original branches
+static double random_legacy(unsigned long long events, unsigned long long *matches)
+{
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    legacy_state_t legacy = {0};
+    uint64_t bits = 0;
+    *matches = 0;
+
+    double start = now_s();
+    for (unsigned long long i = 0; i < events; i++)
+    {
+        if ((i & 63) == 0)
+        {
+            bits = xorshift64(&seed);
+        }
+        *matches += legacy_apply(&legacy, bits & 1);
+        bits >>= 1;
+    }
+    return now_s() - start;
+}
+
+static bool same_state(const rules_state_t *a, const rules_state_t *b)
+{
+    return rules_pack(a) == rules_pack(b);
+}
+
+// Plays points on a history as the game task does and undoes them all
+static void check_history(void)
+{
+    static history_t history;
+    rules = &rules_formats[RULES_FORMAT_CLASSIC];
+    rules_state_t state = rules_initial(), undone;
+    history_reset(&history);
+    history_start(&history, &state);
+    for (int i = 0; i < 5; i++)
+    {
+        state = rules_apply(rules, state, i % 2).state;
+        history_push(&history, &state, i % 2);
+    }
+
+    // A restart: the points before it must stay out of reach
+    rules_state_t restarted = rules_initial();
+    history_start(&history, &restarted);
+    state = restarted;
+    for (int i = 0; i < 2; i++)
+    {
+        state = rules_apply(rules, state, RULES_EVENT_SIDE_1).state;
+        history_push(&history, &state, RULES_SIDE_1);
+    }
+    CHECK(history_undoable(&history) == 2, state, 0, "%u points undoable after the restart, expected 2",
+          (unsigned)history_undoable(&history));
+    for (int i = 0; i < 2; i++)
+    {
+        CHECK(history_undo(&history, &state), state, 0, "undo %d after the restart refused", i + 1);
+    }
+    CHECK(same_state(&state, &restarted), state, 0, "undo did not end at the restart");
+    undone = state;
+    CHECK(!history_undo(&history, &undone), state, 0, "undo crossed the restart into the previous match");
+    CHECK(same_state(&undone, &state), state, 0, "refused undo changed the state");
+
+    // A format change resets the history and starts the new format
+    rules = &rules_formats[RULES_FORMAT_COUNT - 1];
+    history_reset(&history);
+    history_start(&history, &restarted);
+    undone = restarted;
+    CHECK(!history_undo(&history, &undone), restarted, 0, "undo crossed a format change");
+    rules = &rules_formats[RULES_FORMAT_CLASSIC];
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long events = argc > 1 ? strtoull(argv[1], NULL, 10) : DEFAULT_RANDOM_EVENTS;
+
+    for (int format = 0; format < RULES_FORMAT_COUNT; format++)
+    {
+        rules = &rules_formats[format];
+        explore();
+    }
+    check_history();
+
+    printf("random: %llu events\n", events);
+    unsigned long long matches, legacy_matches;
+    for (int format = 0; format < RULES_FORMAT_COUNT; format++)
+    {
+        rules = &rules_formats[format];
+        double engine_s = random_engine(events, &matches);
+        printf("  rules_apply %-8s %8.1f Mevents/s, %llu matches\n", rules->name, events / engine_s / 1e6, matches);
+    }
+    rules = &rules_formats[RULES_FORMAT_CLASSIC];
+    random_engine(events, &matches);
+    double legacy_s = random_legacy(events, &legacy_matches);
+    CHECK(matches == legacy_matches, rules_initial(), 0, "%llu matches vs %llu with the original branches", matches,
+          legacy_matches);
+    printf("  original branches    %8.1f Mevents/s, %llu matches\n", events / legacy_s / 1e6, legacy_matches);
+
+    if (violations)
+    {
+        printf("FAILED: %u violations\n", violations);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <stdio.h>
+#include "persist_file.h"
+
+#define PATH_MAX_LEN 512
+
+static void slot_path(const char *dir, int slot, char *path, size_t size)
+{
+    snprintf(path, size, "%s/match%d", dir, slot);
+}
+
+static esp_err_t persist_file_read(void *ctx, int slot, uint64_t *record)
+{
+    char path[PATH_MAX_LEN];
+    slot_path(ctx, slot, path, sizeof(path));
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        return ESP_ERR_NOT_FOUND;
+    }
+    size_t read = fread(record, sizeof(*record), 1, file);
+    fclose(file);
+    return read == 1 ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t persist_file_write(void *ctx, int slot, uint64_t record)
+{
+    char path[PATH_MAX_LEN], temp[PATH_MAX_LEN + 4];
+    slot_path(ctx, slot, path, sizeof(path));
+    snprintf(temp, sizeof(temp), "%s.new", path);
+    FILE *file = fopen(temp, "wb");
+    if (!file)
+    {
+        return ESP_FAIL;
+    }
+    size_t written = fwrite(&record, sizeof(record), 1, file);
+    if (fclose(file) != 0 || written != 1)
+    {
+        return ESP_FAIL;
+    }
+    return rename(temp, path) == 0 ? ESP_OK : ESP_FAIL;
+}
+
+void persist_file_backend(persist_backend_t *backend, const char *dir)
+{
+    *backend = (persist_backend_t){
+        .read = persist_file_read,
+        .write = persist_file_write,
+        .ctx = (void *)dir,
+    };
+}
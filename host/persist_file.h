@@ -0,0 +1,8 @@
+// File-backed stand-in for the NVS backend of main/persist.h.
+#pragma once
+
+#include "persist.h"
+
+// One file per slot in dir ("match0", "match1"), replaced with a rename so a
+// write is all or nothing, as an NVS entry is.
+void persist_file_backend(persist_backend_t *backend, const char *dir);
@@ -0,0 +1,198 @@
+// Checks main/persist.c on top of the file backend: saves every state of
+// random matches in every format, "reboots" at random points and expects the
+// last save back,
+// then damages the newest slot the ways a power cut or a bad flash cell could
+// and expects the save before it.
+//
+// Usage: persist_sim [dir]   (default: a fresh directory under /tmp;
+//                             exit status 1 on any failure)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "persist_file.h"
+#include "rules.h"
+
+#define EVENTS 5000
+
+static unsigned failures = 0;
+static char dir[256];
+
+#define CHECK(cond, ...)                 \
+    do                                   \
+    {                                    \
+        if (!(cond))                     \
+        {                                \
+            if (failures++ < 20)         \
+            {                            \
+                printf("FAIL: ");        \
+                printf(__VA_ARGS__);     \
+                printf("\n");            \
+            }                            \
+        }                                \
+    } while (0)
+
+static bool same(const rules_state_t *a, const rules_state_t *b)
+{
+    return rules_pack(a) == rules_pack(b);
+}
+
+// What the board does at boot
+static bool reboot(rules_state_t *state, uint8_t *format)
+{
+    persist_backend_t backend;
+    persist_file_backend(&backend, dir);
+    persist_init(&backend);
+    return persist_load(state, format);
+}
+
+// Slot holding the newest record, found through the files themselves
+static int newest_slot(void)
+{
+    int newest = -1;
+    uint32_t newest_seq = 0;
+    for (int slot = 0; slot < PERSIST_SLOTS; slot++)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/match%d", dir, slot);
+        FILE *file = fopen(path, "rb");
+        uint64_t record;
+        uint32_t seq;
+        rules_state_t state;
+        uint8_t format;
+        if (file && fread(&record, sizeof(record), 1, file) == 1 && persist_decode(record, &seq, &state, &format) &&
+            (newest < 0 || seq > newest_seq))
+        {
+            newest = slot;
+            newest_seq = seq;
+        }
+        if (file)
+        {
+            fclose(file);
+        }
+    }
+    return newest;
+}
+
+static void damage(int slot, bool truncate)
+{
+    char path[512];
+    snprintf(path, sizeof(path), "%s/match%d", dir, slot);
+    FILE *file = fopen(path, "r+b");
+    if (!file)
+    {
+        return;
+    }
+    if (truncate)
+    {
+        fclose(fopen(path, "wb"));
+    }
+    else
+    {
+        // One flipped bit anywhere in the record
+        uint64_t record;
+        if (fread(&record, sizeof(record), 1, file) == 1)
+        {
+            record ^= 1ULL << (rand() % 64);
+            rewind(file);
+            fwrite(&record, sizeof(record), 1, file);
+        }
+    }
+    fclose(file);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        snprintf(dir, sizeof(dir), "%s", argv[1]);
+    }
+    else
+    {
+        snprintf(dir, sizeof(dir), "/tmp/persist_sim.XXXXXX");
+        if (!mkdtemp(dir))
+        {
+            perror("mkdtemp");
+            return 2;
+        }
+    }
+    for (int slot = 0; slot < PERSIST_SLOTS; slot++)
+    {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/match%d", dir, slot);
+        remove(path);
+    }
+    srand(1);
+
+    rules_state_t loaded;
+    uint8_t loaded_format;
+    CHECK(!reboot(&loaded, &loaded_format), "state found in an empty directory");
+
+    // Every record decodes to what was encoded, and no single flipped bit gets through
+    for (uint8_t format = 0; format < RULES_FORMAT_COUNT; format++)
+    {
+        for (uint32_t packed = 0; packed < 1 << 12; packed++)
+        {
+            rules_state_t state = rules_unpack(packed), decoded;
+            uint32_t seq;
+            uint8_t decoded_format;
+            uint64_t record = persist_encode(packed * 7919u, &state, format);
+            bool valid = rules_valid(&rules_formats[format], &state);
+            CHECK(persist_decode(record, &seq, &decoded, &decoded_format) == valid, "record of %03x in %s %s", packed,
+                  rules_formats[format].name, valid ? "rejected" : "accepted");
+            CHECK(!valid || (seq == packed * 7919u && same(&state, &decoded) && decoded_format == format),
+                  "record of %03x in %s decodes wrong", packed, rules_formats[format].name);
+            for (int bit = 0; bit < 64; bit++)
+            {
+                CHECK(!persist_decode(record ^ 1ULL << bit, &seq, &decoded, &decoded_format),
+                      "bit %d flip of %03x accepted", bit, packed);
+            }
+        }
+    }
+
+    uint8_t format = RULES_FORMAT_CLASSIC, previous_format = format;
+    rules_state_t match = rules_initial(), previous = match;
+    unsigned writes = 0, reboots = 0, damaged = 0;
+    for (unsigned i = 0; i < EVENTS; i++)
+    {
+        previous = match;
+        previous_format = format;
+        rules_result_t result = rules_apply(&rules_formats[format], match, rand() & 1);
+        match = result.state;
+        if (result.effects & RULES_EFFECT_END)
+        {
+            format = (format + 1) % RULES_FORMAT_COUNT;
+        }
+        CHECK(persist_store(&match, format) == ESP_OK, "store %u failed", i);
+        writes++;
+
+        if (rand() % 8 == 0)
+        {
+            reboots++;
+            CHECK(reboot(&loaded, &loaded_format) && same(&loaded, &match) && loaded_format == format,
+                  "reboot %u: last save not restored", reboots);
+        }
+        if (i > 0 && rand() % 16 == 0)
+        {
+            // Lost the newest save: the one before it must come back, and saving goes on from there
+            damaged++;
+            damage(newest_slot(), rand() & 1);
+            CHECK(reboot(&loaded, &loaded_format) && same(&loaded, &previous) && loaded_format == previous_format,
+                  "damage %u: previous save not restored", damaged);
+            match = loaded;
+            format = loaded_format;
+        }
+    }
+
+    printf("%u saves, %u reboots, %u damaged slots, files in %s\n", writes, reboots, damaged, dir);
+    if (failures)
+    {
+        printf("FAILED: %u failures\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,227 @@
+// Button wake-up from light sleep with mocked timings: main/debounce.c runs
+// against a simulated pin that bounces and glitches, on a chip that sleeps
+// whenever it has been idle for the FreeRTOS idle time and takes a random
+// wake-up latency from the ranges below to reach the GPIO ISR. Checks that
+// every press and release is reported exactly once, in order, and that what
+// sleeping adds to first edge -> queued stays within the debounce window.
+// The same presses are then played on a chip that never sleeps, to compare.
+//
+// Usage: power_sim [presses]   (exit status 1 on any failure)
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "debounce.h"
+
+#define DEFAULT_PRESSES 20000
+#define MAX_EDGES 16
+
+// Firmware settings, as in main.c and sdkconfig
+#define DEBOUNCE_US 30000
+#define IDLE_BEFORE_SLEEP_US 30000 // CONFIG_FREERTOS_IDLE_TIME_BEFORE_SLEEP ticks at 100Hz
+
+// Mocked timings
+#define WAKE_MIN_US 250     // GPIO wake-up to ISR: clocks, PLL and DFS back up
+#define WAKE_MAX_US 1500
+#define TIMER_JITTER_US 200 // esp_timer wake-up from light sleep, around its deadline
+#define ISR_US 5            // edge to ISR on an awake chip
+#define TASK_US 40          // ISR or timer to the input task having queued or armed
+#define BOUNCE_MAX_US 8000  // contacts settle within this
+#define HOLD_MIN_US 60000   // shortest press, and shortest gap between presses
+#define HOLD_MAX_US 1500000
+#define GLITCH_PERCENT 10   // gaps with a spike of noise that must not count
+
+typedef struct
+{
+    int64_t time_us;
+    int level;
+} edge_t;
+
+typedef struct
+{
+    int64_t edge_us; // physical first edge
+    bool down;
+} change_t;
+
+typedef struct
+{
+    unsigned events;
+    unsigned failures;
+    int64_t total_extra_us; // beyond DEBOUNCE_US
+    int64_t max_extra_us;
+    unsigned woken;
+} run_t;
+
+static uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t xorshift64(void)
+{
+    uint64_t x = seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return seed = x;
+}
+
+static int64_t between(int64_t low, int64_t high)
+{
+    return low + (int64_t)(xorshift64() % (uint64_t)(high - low + 1));
+}
+
+// One press, or one glitch, of a pin idle at high: its edges from start_us
+static int make_action(int64_t start_us, bool glitch, edge_t *edges, change_t *changes, int *change_count)
+{
+    int count = 0;
+    int64_t t = start_us;
+    if (glitch)
+    {
+        edges[count++] = (edge_t){t, 0};
+        edges[count++] = (edge_t){t + between(100, 3000), 1};
+        return count;
+    }
+    for (int level = 0; level <= 1; level++)
+    {
+        // Bounces: the pin toggles a few times, then rests at level
+        changes[(*change_count)++] = (change_t){.edge_us = t, .down = !level};
+        int bounces = between(0, 3);
+        if (!bounces)
+        {
+            edges[count++] = (edge_t){t, level};
+            t += between(HOLD_MIN_US, HOLD_MAX_US);
+            continue;
+        }
+        int64_t settle_us = t + between(0, BOUNCE_MAX_US);
+        for (int i = 0; i < bounces && t < settle_us; i++)
+        {
+            edges[count++] = (edge_t){t, level};
+            edges[count++] = (edge_t){t + 50, !level};
+            t += between(100, (settle_us - t) / 2 + 100);
+        }
+        edges[count++] = (edge_t){t > settle_us ? t : settle_us, level};
+        t = (t > settle_us ? t : settle_us) + between(HOLD_MIN_US, HOLD_MAX_US);
+    }
+    return count;
+}
+
+static int level_at(const edge_t *edges, int count, int64_t time_us)
+{
+    int level = 1;
+    for (int i = 0; i < count && edges[i].time_us <= time_us; i++)
+    {
+        level = edges[i].level;
+    }
+    return level;
+}
+
+// First time from time_us on where the pin is at level, or INT64_MAX
+static int64_t next_at(const edge_t *edges, int count, int64_t time_us, int level)
+{
+    if (level_at(edges, count, time_us) == level)
+    {
+        return time_us;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (edges[i].time_us > time_us && edges[i].level == level)
+        {
+            return edges[i].time_us;
+        }
+    }
+    return INT64_MAX;
+}
+
+static void play(unsigned presses, bool sleeps, run_t *run)
+{
+    seed = 0x9e3779b97f4a7c15ULL;
+    debounce_t debounce;
+    debounce_init(&debounce, 1);
+    int64_t now_us = 0, active_us = 0;
+
+    for (unsigned action = 0; action < presses; action++)
+    {
+        // The pin of one action; the chip carries on from where the last one left it
+        edge_t edges[MAX_EDGES];
+        change_t changes[2];
+        int change_count = 0;
+        bool glitch = xorshift64() % 100 < GLITCH_PERCENT;
+        int64_t start_us = now_us + between(HOLD_MIN_US, HOLD_MAX_US);
+        int count = make_action(start_us, glitch, edges, changes, &change_count);
+        int64_t end_us = edges[count - 1].time_us + HOLD_MIN_US;
+        int reported = 0;
+
+        while (1)
+        {
+            int64_t fires_us = next_at(edges, count, now_us, debounce_wait_level(&debounce));
+            if (fires_us >= end_us)
+            {
+                break;
+            }
+            bool asleep = sleeps && fires_us - active_us >= IDLE_BEFORE_SLEEP_US;
+            run->woken += asleep;
+            int64_t isr_us = fires_us + (asleep ? between(WAKE_MIN_US, WAKE_MAX_US) : ISR_US);
+            if (!debounce_edge(&debounce, isr_us))
+            {
+                run->failures++;
+                printf("FAIL: interrupt with the window open at %lldus\n", (long long)isr_us);
+            }
+            int64_t settle_us = isr_us + TASK_US + DEBOUNCE_US + (sleeps ? between(0, TIMER_JITTER_US) : 0);
+            int level = level_at(edges, count, settle_us);
+            if (debounce_settled(&debounce, level))
+            {
+                int64_t queued_us = settle_us + TASK_US;
+                if (reported == change_count || changes[reported].down != !level)
+                {
+                    run->failures++;
+                    printf("FAIL: unexpected %s at %lldus\n", level ? "release" : "press", (long long)queued_us);
+                }
+                else
+                {
+                    int64_t extra_us = queued_us - changes[reported].edge_us - DEBOUNCE_US;
+                    run->total_extra_us += extra_us;
+                    run->max_extra_us = extra_us > run->max_extra_us ? extra_us : run->max_extra_us;
+                    if (extra_us >= DEBOUNCE_US)
+                    {
+                        run->failures++;
+                        printf("FAIL: %lldus past the window\n", (long long)extra_us);
+                    }
+                    reported++;
+                    run->events++;
+                }
+            }
+            now_us = settle_us + TASK_US;
+            active_us = now_us;
+        }
+        if (reported != change_count)
+        {
+            run->failures++;
+            printf("FAIL: %d of %d changes reported for the action at %lldus\n", reported, change_count,
+                   (long long)start_us);
+        }
+        now_us = end_us;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned presses = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_PRESSES;
+    run_t runs[2] = {{0}};
+    const char *names[2] = {"awake", "light sleep"};
+    for (int sleeps = 0; sleeps <= 1; sleeps++)
+    {
+        run_t *run = &runs[sleeps];
+        play(presses, sleeps, run);
+        printf("%-12s %6u changes, %6u wake-ups, first edge -> queued: window + %lldus mean, + %lldus max\n",
+               names[sleeps], run->events, run->woken, (long long)(run->events ? run->total_extra_us / run->events : 0),
+               (long long)run->max_extra_us);
+    }
+    unsigned failures = runs[0].failures + runs[1].failures;
+    if (failures)
+    {
+        printf("%u failures\n", failures);
+        return 1;
+    }
+    printf("OK: sleeping adds at most %lldus to a %dus debounce window\n",
+           (long long)(runs[1].max_extra_us - runs[0].max_extra_us), DEBOUNCE_US);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// Host implementation of main/render.h: render_submit() plays the frame, and
+// its animation, synchronously in the caller at the configured rate. An
+// endless animation is played for RENDER_HOST_ENDLESS_MS since nothing can
+// interrupt it here.
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "render.h"
+#include "render_host.h"
+
+#define RENDER_HOST_ENDLESS_MS 2000
+
+static uint32_t render_fps = 60;
+static bool render_realtime = false;
+static frame_t front;
+static render_stats_t stats;
+static int64_t producer_event_us = 0;
+static int64_t pending_event_us = 0; // as in main/render.c
+static uint32_t photons = 0;
+static uint32_t photons_unchanged = 0;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void render_sleep(uint32_t ms)
+{
+    if (render_realtime && ms)
+    {
+        usleep(ms * 1000);
+    }
+}
+
+// tick is the frame period of the submit being played, for the latency
+static void render_present(const frame_t *frame, uint32_t tick)
+{
+    bool changed = memcmp(frame, &front, sizeof(front)) != 0;
+    front = *frame;
+    uint32_t sent = framebuffer_present(&front);
+    stats.presented++;
+    if (pending_event_us && sent)
+    {
+        stats.last_latency_us = tick * 1000000 / render_fps;
+        if (stats.last_latency_us > stats.max_latency_us)
+        {
+            stats.max_latency_us = stats.last_latency_us;
+        }
+        photons++;
+        photons_unchanged += !changed;
+        pending_event_us = 0;
+    }
+}
+
+void render_init(uint32_t fps)
+{
+    render_fps = fps;
+    framebuffer_snapshot(&front);
+}
+
+void render_host_set_realtime(bool realtime)
+{
+    render_realtime = realtime;
+}
+
+bool render_submit_anim(const anim_t *anim, uint32_t hold_ms)
+{
+    frame_t to, out;
+    framebuffer_snapshot(&to);
+    stats.submitted++;
+    pending_event_us = producer_event_us;
+    producer_event_us = 0;
+
+    uint32_t tick = 0;
+    if (anim && anim->kind != ANIM_NONE)
+    {
+        frame_t from = front;
+        uint32_t duration_ms = anim->duration_ms ? anim->duration_ms : RENDER_HOST_ENDLESS_MS;
+        for (;; tick++)
+        {
+            uint32_t elapsed_ms = tick * 1000 / render_fps;
+            if (elapsed_ms >= duration_ms)
+            {
+                break;
+            }
+            uint64_t start = now_ns();
+            anim_frame(anim, &from, &to, elapsed_ms, &out);
+            uint32_t anim_ns = now_ns() - start;
+            stats.last_anim_ns = anim_ns;
+            if (anim_ns > stats.max_anim_ns)
+            {
+                stats.max_anim_ns = anim_ns;
+            }
+            stats.anim_frames++;
+            render_present(&out, tick);
+            render_sleep(1000 / render_fps);
+        }
+    }
+    render_present(&to, tick);
+    render_sleep(hold_ms);
+    // Nothing is queued behind it here: the render task would go idle
+    framebuffer_release();
+    stats.idle_periods++;
+    return true;
+}
+
+bool render_submit(uint32_t hold_ms)
+{
+    return render_submit_anim(NULL, hold_ms);
+}
+
+// The latency is counted in frame periods from the submit, the time taken to
+// get there is the caller's
+void render_stamp(int64_t event_us)
+{
+    producer_event_us = event_us;
+}
+
+void render_host_photons(uint32_t *count, uint32_t *unchanged)
+{
+    *count = photons;
+    *unchanged = photons_unchanged;
+}
+
+void render_get_stats(render_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,13 @@
+// Host-only controls of host/render_host.c.
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// With realtime, frames are paced with sleeps like on the board; without it
+// every queued frame is presented at once.
+void render_host_set_realtime(bool realtime);
+
+// Stamped frames that reached the strips, and how many of those showed the
+// same pixels as the frame before them, which would make the latency a lie.
+void render_host_photons(uint32_t *count, uint32_t *unchanged);
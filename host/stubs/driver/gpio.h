@@ -0,0 +1,15 @@
+// Host stand-in for the few ESP-IDF GPIO calls of the strip data pins. A held
+// pin is latched as on the chip: the RMT stub refuses to transmit on it.
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+esp_err_t gpio_sleep_sel_dis(gpio_num_t gpio_num);
+esp_err_t gpio_hold_en(gpio_num_t gpio_num);
+esp_err_t gpio_hold_dis(gpio_num_t gpio_num);
+
+// Host-only helper
+bool host_gpio_held(gpio_num_t gpio_num);
@@ -0,0 +1,43 @@
+// Host stand-in for the ESP-IDF RMT TX driver. Transmissions do not go
+// anywhere: the last frame sent on each channel is kept so a host program can
+// inspect or draw it, and every transmission is counted. As on the chip, a
+// channel only transmits between rmt_enable() and rmt_disable(), and an
+// encoder serves one transmission at a time: until rmt_tx_wait_all_done() on
+// its channel, another channel cannot transmit with it. Nothing goes out on a
+// pin held with gpio_hold_en().
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
+
+typedef struct
+{
+    int gpio_num;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+} rmt_tx_channel_config_t;
+
+typedef struct
+{
+    int loop_count;
+} rmt_transmit_config_t;
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config);
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int timeout_ms);
+
+// Host-only helpers
+esp_err_t host_rmt_new_encoder(rmt_encoder_handle_t *ret_encoder);
+typedef void (*host_rmt_hook_t)(rmt_channel_handle_t channel, void *arg);
+void host_rmt_set_transmit_hook(host_rmt_hook_t hook, void *arg);
+const uint8_t *host_rmt_frame(rmt_channel_handle_t channel, size_t *bytes);
+uint32_t host_rmt_transmissions(rmt_channel_handle_t channel);
+int host_rmt_gpio(rmt_channel_handle_t channel);
@@ -0,0 +1,6 @@
+// Host stand-in for the ESP-IDF header of the same name.
+#pragma once
+
+#include <stdint.h>
+
+#define portMAX_DELAY 0xffffffffu
@@ -0,0 +1,41 @@
+#include <stdint.h>
+#include "driver/gpio.h"
+
+#define HOST_GPIO_COUNT 40
+
+static bool held[HOST_GPIO_COUNT];
+
+static bool valid(gpio_num_t gpio_num)
+{
+    return gpio_num >= 0 && gpio_num < HOST_GPIO_COUNT;
+}
+
+esp_err_t gpio_sleep_sel_dis(gpio_num_t gpio_num)
+{
+    return valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_hold_en(gpio_num_t gpio_num)
+{
+    if (!valid(gpio_num))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    held[gpio_num] = true;
+    return ESP_OK;
+}
+
+esp_err_t gpio_hold_dis(gpio_num_t gpio_num)
+{
+    if (!valid(gpio_num))
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    held[gpio_num] = false;
+    return ESP_OK;
+}
+
+bool host_gpio_held(gpio_num_t gpio_num)
+{
+    return valid(gpio_num) && held[gpio_num];
+}
@@ -0,0 +1,151 @@
+#include <stdbool.h>
+#include <string.h>
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+
+#define HOST_RMT_CHANNELS 8
+#define HOST_RMT_FRAME_BYTES 4096
+#define HOST_RMT_ENCODERS 8
+
+struct rmt_encoder_t
+{
+    rmt_channel_handle_t busy_on; // channel whose transmission it is encoding, until waited for
+};
+
+struct rmt_channel_t
+{
+    int gpio_num;
+    bool enabled;
+    rmt_encoder_handle_t encoding; // encoder of the transmission in flight
+    uint32_t transmissions;
+    size_t frame_bytes;
+    uint8_t frame[HOST_RMT_FRAME_BYTES];
+};
+
+static struct rmt_channel_t channels[HOST_RMT_CHANNELS];
+static int channel_count = 0;
+static struct rmt_encoder_t encoders[HOST_RMT_ENCODERS];
+static int encoder_count = 0;
+static host_rmt_hook_t transmit_hook = NULL;
+static void *transmit_hook_arg = NULL;
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan)
+{
+    if (!config || !ret_chan)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel_count == HOST_RMT_CHANNELS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    struct rmt_channel_t *channel = &channels[channel_count++];
+    memset(channel, 0, sizeof(*channel));
+    channel->gpio_num = config->gpio_num;
+    *ret_chan = channel;
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel)
+{
+    if (!channel)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel->enabled)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel)
+{
+    if (!channel)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!channel->enabled)
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    channel->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config)
+{
+    (void)config;
+    if (!channel || !encoder || !payload || payload_bytes > HOST_RMT_FRAME_BYTES)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // On the chip, a second transaction resets the encoder under the first one's refills
+    if (!channel->enabled || host_gpio_held(channel->gpio_num) || (encoder->busy_on && encoder->busy_on != channel))
+    {
+        return ESP_ERR_INVALID_STATE;
+    }
+    encoder->busy_on = channel;
+    channel->encoding = encoder;
+    memcpy(channel->frame, payload, payload_bytes);
+    channel->frame_bytes = payload_bytes;
+    channel->transmissions++;
+    if (transmit_hook)
+    {
+        transmit_hook(channel, transmit_hook_arg);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t channel, int timeout_ms)
+{
+    (void)timeout_ms;
+    if (!channel)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (channel->encoding)
+    {
+        channel->encoding->busy_on = NULL;
+        channel->encoding = NULL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t host_rmt_new_encoder(rmt_encoder_handle_t *ret_encoder)
+{
+    if (!ret_encoder)
+    {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (encoder_count == HOST_RMT_ENCODERS)
+    {
+        return ESP_ERR_NO_MEM;
+    }
+    *ret_encoder = &encoders[encoder_count++];
+    return ESP_OK;
+}
+
+void host_rmt_set_transmit_hook(host_rmt_hook_t hook, void *arg)
+{
+    transmit_hook = hook;
+    transmit_hook_arg = arg;
+}
+
+const uint8_t *host_rmt_frame(rmt_channel_handle_t channel, size_t *bytes)
+{
+    *bytes = channel->frame_bytes;
+    return channel->frame;
+}
+
+uint32_t host_rmt_transmissions(rmt_channel_handle_t channel)
+{
+    return channel->transmissions;
+}
+
+int host_rmt_gpio(rmt_channel_handle_t channel)
+{
+    return channel->gpio_num;
+}
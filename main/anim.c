@@ -0,0 +1,109 @@
+#include <string.h>
+#include "anim.h"
+
+#define ANIM_ONE 256 // 1.0 in 8.8 fixed point
+#define ANIM_PULSE_FLOOR 24 // a pulsing LED never goes fully dark
+#define ANIM_CHASE_TAIL 3
+
+static void blend(uint8_t *out, const uint8_t *a, const uint8_t *b, uint32_t alpha, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        out[i] = (a[i] * (ANIM_ONE - alpha) + b[i] * alpha) >> 8;
+    }
+}
+
+static void blend_pixel(uint8_t *pixels, int position, rgb color, uint32_t alpha)
+{
+    // WS2812 wire order is G, R, B
+    const uint8_t wire[3] = {color.green, color.red, color.blue};
+    blend(&pixels[position * 3], &pixels[position * 3], wire, alpha, 3);
+}
+
+// Triangle wave over a period: 0 -> ANIM_ONE -> 0
+static uint32_t triangle(uint32_t elapsed_ms, uint32_t period_ms)
+{
+    uint32_t half = period_ms / 2;
+    uint32_t phase = elapsed_ms % period_ms;
+    if (!half)
+    {
+        return ANIM_ONE;
+    }
+    return phase < half ? phase * ANIM_ONE / half : (period_ms - phase) * ANIM_ONE / half;
+}
+
+static void anim_strip(const anim_t *anim, const uint8_t *from, const uint8_t *to, uint32_t elapsed_ms, uint8_t *out)
+{
+    const int bytes = LED_NUMBERS * 3;
+    switch (anim->kind)
+    {
+    case ANIM_BLINK:
+        if (anim->period_ms && elapsed_ms % anim->period_ms < anim->period_ms / 2)
+        {
+            memset(out, 0, bytes);
+        }
+        else
+        {
+            memcpy(out, to, bytes);
+        }
+        break;
+    case ANIM_CROSSFADE:
+    {
+        uint32_t alpha = ANIM_ONE;
+        if (anim->duration_ms && elapsed_ms < anim->duration_ms)
+        {
+            alpha = elapsed_ms * ANIM_ONE / anim->duration_ms;
+        }
+        blend(out, from, to, alpha, bytes);
+        break;
+    }
+    case ANIM_CHASE:
+    {
+        memcpy(out, to, bytes);
+        uint32_t head = anim->period_ms ? elapsed_ms / anim->period_ms : 0;
+        for (int digit = 0; digit < DISPLAY_DIGITS; digit++)
+        {
+            for (int tail = 0; tail < ANIM_CHASE_TAIL; tail++)
+            {
+                int position = digit * DIGIT_LEDS + (head + ANIM_CHASE_LEDS - tail) % ANIM_CHASE_LEDS;
+                blend_pixel(out, position, anim->color, ANIM_ONE >> tail);
+            }
+        }
+        break;
+    }
+    case ANIM_PULSE:
+    {
+        memcpy(out, to, bytes);
+        uint32_t level = ANIM_PULSE_FLOOR + (triangle(elapsed_ms, anim->period_ms) * (ANIM_ONE - ANIM_PULSE_FLOOR) >> 8);
+        uint8_t *set = &out[LED_SET_GAME * 3];
+        for (int i = 0; i < 3; i++)
+        {
+            set[i] = set[i] * level >> 8;
+        }
+        break;
+    }
+    default:
+        memcpy(out, to, bytes);
+        break;
+    }
+}
+
+void anim_frame(const anim_t *anim, const frame_t *from, const frame_t *to, uint32_t elapsed_ms, frame_t *out)
+{
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        if (anim->strips & (1u << strip))
+        {
+            anim_strip(anim, from->pixels[strip], to->pixels[strip], elapsed_ms, out->pixels[strip]);
+        }
+        else
+        {
+            memcpy(out->pixels[strip], to->pixels[strip], sizeof(out->pixels[strip]));
+        }
+    }
+}
+
+bool anim_done(const anim_t *anim, uint32_t elapsed_ms)
+{
+    return anim->duration_ms && elapsed_ms >= anim->duration_ms;
+}
@@ -0,0 +1,36 @@
+#ifndef _ANIM_H__
+#define _ANIM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "framebuffer.h"
+
+// Transitions computed frame by frame between what the strips showed when the
+// animation started (from) and a target frame (to), with 8.8 fixed-point
+// blending: no floats and no divisions per pixel.
+
+#define ANIM_NONE 0
+#define ANIM_BLINK 1     // target and blank alternate, blank first, every half period
+#define ANIM_CROSSFADE 2 // from fades into target over the duration
+#define ANIM_CHASE 3     // a comet of color runs clockwise around every digit, one LED per period
+#define ANIM_PULSE 4     // the set LED of the target breathes, one breath per period
+
+#define ANIM_CHASE_LEDS (PERIMETER_SEGMENTS * DISPLAY_SEGMENT_PIXELS) // first LEDs of a digit, clockwise around it
+#define ANIM_ALL_STRIPS ((1u << STRIP_COUNT) - 1)
+
+typedef struct
+{
+    uint8_t kind;         // ANIM_*
+    uint8_t strips;       // bit mask (1 << strip) of the animated strips, the others show the target
+    uint16_t duration_ms; // 0 runs until the next frame is queued
+    uint16_t period_ms;
+    rgb color; // comet color of ANIM_CHASE
+} anim_t;
+
+// Frame elapsed_ms into the animation.
+void anim_frame(const anim_t *anim, const frame_t *from, const frame_t *to, uint32_t elapsed_ms, frame_t *out);
+
+// True once a finite animation has run its duration; the target is then shown as is.
+bool anim_done(const anim_t *anim, uint32_t elapsed_ms);
+
+#endif
@@ -0,0 +1,181 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "sched.h"
+#include "sysmem.h"
+#include "buzzer.h"
+
+#define BUZZER_QUEUE_DEPTH 4
+#define BUZZER_TASK_STACK 2048
+#define BUZZER_DEFAULT_TONE_HZ 2700
+
+#define BUZZER_LEDC_MODE LEDC_LOW_SPEED_MODE
+#define BUZZER_LEDC_TIMER LEDC_TIMER_0
+#define BUZZER_LEDC_CHANNEL LEDC_CHANNEL_0
+#define BUZZER_LEDC_DUTY_RESOLUTION LEDC_TIMER_10_BIT
+#define BUZZER_LEDC_DUTY_HALF (1 << (10 - 1))
+
+typedef struct
+{
+    const buzzer_pattern_t *pattern;
+    int64_t queued_us;
+} buzzer_event_t;
+
+const buzzer_pattern_t BUZZER_START = BUZZER_PATTERN(
+    {.on = 1, .duration_ms = 1000},
+    {.on = 0, .duration_ms = 100},
+    {.on = 1, .duration_ms = 100},
+    {.on = 0, .duration_ms = 100},
+    {.on = 1, .duration_ms = 100});
+
+const buzzer_pattern_t BUZZER_POINT = BUZZER_PATTERN(
+    {.on = 1, .duration_ms = 150},
+    {.on = 0, .duration_ms = 30},
+    {.on = 1, .duration_ms = 600});
+
+const buzzer_pattern_t BUZZER_INVERT = BUZZER_PATTERN(
+    {.on = 1, .duration_ms = 500},
+    {.on = 0, .duration_ms = 200},
+    {.on = 1, .duration_ms = 400},
+    {.on = 0, .duration_ms = 400},
+    {.on = 1, .duration_ms = 400},
+    {.on = 0, .duration_ms = 400},
+    {.on = 1, .duration_ms = 500});
+
+const buzzer_pattern_t BUZZER_END = BUZZER_PATTERN(
+    {.on = 1, .duration_ms = 1000},
+    {.on = 0, .duration_ms = 100},
+    {.on = 1, .duration_ms = 100},
+    {.on = 0, .duration_ms = 100},
+    {.on = 1, .duration_ms = 100});
+
+const buzzer_pattern_t BUZZER_UNDO = BUZZER_PATTERN(
+    {.on = 1, .duration_ms = 80},
+    {.on = 0, .duration_ms = 80},
+    {.on = 1, .duration_ms = 80});
+
+static const char *TAG = "buzzer";
+static QueueHandle_t buzzer_queue = NULL;
+static int buzzer_gpio_num = -1;
+static bool buzzer_use_ledc = false;
+static esp_pm_lock_handle_t buzzer_pm_lock = NULL; // LEDC tones need the APB clock steady
+static buzzer_stats_t stats = {0};
+
+static void buzzer_output(const buzzer_step_t *step)
+{
+    if (!buzzer_use_ledc)
+    {
+        gpio_set_level(buzzer_gpio_num, step->on);
+        return;
+    }
+
+    if (step->on)
+    {
+        ledc_set_freq(BUZZER_LEDC_MODE, BUZZER_LEDC_TIMER, step->tone_hz ? step->tone_hz : BUZZER_DEFAULT_TONE_HZ);
+    }
+    ledc_set_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL, step->on ? BUZZER_LEDC_DUTY_HALF : 0);
+    ledc_update_duty(BUZZER_LEDC_MODE, BUZZER_LEDC_CHANNEL);
+}
+
+static void buzzer_task(void *arg)
+{
+    static const buzzer_step_t silence = {.on = 0};
+    buzzer_event_t event;
+    while (1)
+    {
+        if (xQueueReceive(buzzer_queue, &event, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+        stats.last_wait_us = esp_timer_get_time() - event.queued_us;
+        stats.played++;
+        const buzzer_pattern_t *pattern = event.pattern;
+        if (buzzer_pm_lock)
+        {
+            esp_pm_lock_acquire(buzzer_pm_lock);
+        }
+        for (int i = 0; i < pattern->count; i++)
+        {
+            buzzer_output(&pattern->steps[i]);
+            vTaskDelay(pdMS_TO_TICKS(pattern->steps[i].duration_ms));
+        }
+        buzzer_output(&silence);
+        if (buzzer_pm_lock)
+        {
+            esp_pm_lock_release(buzzer_pm_lock);
+        }
+    }
+}
+
+void buzzer_init(int gpio_num, bool use_ledc)
+{
+    buzzer_gpio_num = gpio_num;
+    buzzer_use_ledc = use_ledc;
+
+    if (use_ledc)
+    {
+        ledc_timer_config_t timer_config = {
+            .speed_mode = BUZZER_LEDC_MODE,
+            .timer_num = BUZZER_LEDC_TIMER,
+            .duty_resolution = BUZZER_LEDC_DUTY_RESOLUTION,
+            .freq_hz = BUZZER_DEFAULT_TONE_HZ,
+            .clk_cfg = LEDC_AUTO_CLK,
+        };
+        ESP_ERROR_CHECK(ledc_timer_config(&timer_config));
+        ledc_channel_config_t channel_config = {
+            .gpio_num = gpio_num,
+            .speed_mode = BUZZER_LEDC_MODE,
+            .channel = BUZZER_LEDC_CHANNEL,
+            .timer_sel = BUZZER_LEDC_TIMER,
+            .duty = 0,
+            .hpoint = 0,
+        };
+        ESP_ERROR_CHECK(ledc_channel_config(&channel_config));
+        // ESP_ERR_NOT_SUPPORTED without CONFIG_PM_ENABLE, when there is no scaling to guard against
+        if (esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "buzzer", &buzzer_pm_lock) != ESP_OK)
+        {
+            buzzer_pm_lock = NULL;
+        }
+    }
+    else
+    {
+        gpio_config_t buzzer_config;
+        buzzer_config.intr_type = GPIO_INTR_DISABLE;
+        buzzer_config.mode = GPIO_MODE_OUTPUT;
+        buzzer_config.pin_bit_mask = 1ULL << gpio_num;
+        buzzer_config.pull_down_en = GPIO_PULLDOWN_DISABLE;
+        buzzer_config.pull_up_en = GPIO_PULLUP_DISABLE;
+        ESP_ERROR_CHECK(gpio_config(&buzzer_config));
+        gpio_set_level(gpio_num, 0);
+    }
+
+    buzzer_queue = sysmem_queue(BUZZER_QUEUE_DEPTH, sizeof(buzzer_event_t));
+    sysmem_task(buzzer_task, "buzzer", BUZZER_TASK_STACK, NULL, SCHED_BUZZER_PRIORITY,
+                SCHED_CORE(SCHED_CORE_OUTPUT));
+    ESP_LOGI(TAG, "Buzzer on GPIO %d (%s)", gpio_num, use_ledc ? "LEDC" : "GPIO");
+}
+
+bool buzzer_play(const buzzer_pattern_t *pattern)
+{
+    buzzer_event_t event = {
+        .pattern = pattern,
+        .queued_us = esp_timer_get_time(),
+    };
+    if (xQueueSend(buzzer_queue, &event, 0) != pdTRUE)
+    {
+        stats.dropped++;
+        return false;
+    }
+    return true;
+}
+
+void buzzer_get_stats(buzzer_stats_t *out)
+{
+    *out = stats;
+    out->queued = uxQueueMessagesWaiting(buzzer_queue);
+}
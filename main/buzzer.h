@@ -0,0 +1,51 @@
+#ifndef _BUZZER_H__
+#define _BUZZER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint8_t on;           // 1 = sound, 0 = silence
+    uint16_t tone_hz;     // LEDC tone while on, 0 for the default tone (ignored on plain GPIO)
+    uint16_t duration_ms;
+} buzzer_step_t;
+
+typedef struct
+{
+    const buzzer_step_t *steps;
+    uint8_t count;
+} buzzer_pattern_t;
+
+#define BUZZER_PATTERN(...)                                                            \
+    {                                                                                  \
+        .steps = (const buzzer_step_t[]){__VA_ARGS__},                                 \
+        .count = sizeof((const buzzer_step_t[]){__VA_ARGS__}) / sizeof(buzzer_step_t) \
+    }
+
+typedef struct
+{
+    uint32_t played;
+    uint32_t dropped;      // patterns refused because the queue was full
+    uint32_t last_wait_us; // time the last pattern waited in the queue
+    uint8_t queued;        // patterns waiting right now
+} buzzer_stats_t;
+
+extern const buzzer_pattern_t BUZZER_START;
+extern const buzzer_pattern_t BUZZER_POINT;
+extern const buzzer_pattern_t BUZZER_INVERT;
+extern const buzzer_pattern_t BUZZER_END;
+extern const buzzer_pattern_t BUZZER_UNDO;
+
+// Drives the buzzer from its own low-priority task. With use_ledc the pin is
+// driven by an LEDC PWM channel so steps can play tones; otherwise it is a
+// plain on/off GPIO for an active buzzer.
+void buzzer_init(int gpio_num, bool use_ledc);
+
+// Queues a pattern and returns immediately; patterns play back to back.
+// Returns false if the queue is full and the pattern was dropped.
+bool buzzer_play(const buzzer_pattern_t *pattern);
+
+void buzzer_get_stats(buzzer_stats_t *stats);
+
+#endif
@@ -0,0 +1,201 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_console.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "led_strip_encoder.h"
+#include "framebuffer.h"
+#include "input.h"
+#include "render.h"
+#include "buzzer.h"
+#include "latency.h"
+#include "eventlog.h"
+#include "persist.h"
+#include "sysmem.h"
+#include "sched.h"
+#include "power.h"
+#include "console.h"
+
+static const char *TAG = "console";
+static rmt_encoder_handle_t strip_encoders[STRIP_COUNT] = {NULL};
+static const history_t *match_history = NULL;
+
+// "reset" argument of the latency and jitter commands, which share the histograms
+static bool latency_reset_requested(int argc, char **argv)
+{
+    if (argc < 2 || strcmp(argv[1], "reset") != 0)
+    {
+        return false;
+    }
+    latency_reset();
+    printf("latency histograms cleared\n");
+    return true;
+}
+
+static int cmd_latency(int argc, char **argv)
+{
+    if (latency_reset_requested(argc, argv))
+    {
+        return 0;
+    }
+    latency_dump();
+    return 0;
+}
+
+static int cmd_jitter(int argc, char **argv)
+{
+    if (latency_reset_requested(argc, argv))
+    {
+        return 0;
+    }
+    if (SCHED_PINNED)
+    {
+        printf("scoring on core %d, output on core %d\n", SCHED_CORE_SCORING, SCHED_CORE_OUTPUT);
+    }
+    else
+    {
+        printf("tasks not pinned\n");
+    }
+    latency_jitter();
+    return 0;
+}
+
+static int cmd_log(int argc, char **argv)
+{
+    eventlog_dump_hex();
+    return 0;
+}
+
+static int cmd_history(int argc, char **argv)
+{
+    // The game task keeps scoring while this prints
+    static history_t copy;
+    static uint16_t entries[HISTORY_DEPTH];
+    history_copy(match_history, &copy);
+    size_t count = history_export(&copy, entries, HISTORY_DEPTH);
+    for (size_t i = 0; i < count; i++)
+    {
+        rules_state_t state = rules_unpack(entries[i] & HISTORY_ENTRY_STATE);
+        printf("%3u  %u-%u  sets %u-%u  %s\n", (unsigned)i, state.score[RULES_TEAM_BLUE], state.score[RULES_TEAM_RED],
+               state.sets[RULES_TEAM_BLUE], state.sets[RULES_TEAM_RED],
+               entries[i] & HISTORY_ENTRY_START ? "start" : entries[i] & HISTORY_ENTRY_SIDE ? "side 2" : "side 1");
+    }
+    printf("%u entries kept of %lu since boot\n", (unsigned)count, (unsigned long)copy.head);
+    return 0;
+}
+
+static int cmd_mem(int argc, char **argv)
+{
+    sysmem_report();
+    return 0;
+}
+
+static int cmd_power(int argc, char **argv)
+{
+    power_dump();
+    return 0;
+}
+
+static int cmd_stats(int argc, char **argv)
+{
+    input_stats_t input_stats;
+    input_get_stats(&input_stats);
+    render_stats_t render_stats;
+    render_get_stats(&render_stats);
+    buzzer_stats_t buzzer_stats;
+    buzzer_get_stats(&buzzer_stats);
+    persist_stats_t persist_stats;
+    persist_get_stats(&persist_stats);
+
+    printf("input:  %lu presses, %lu dropped, %lu raw dropped\n", (unsigned long)input_stats.presses,
+           (unsigned long)input_stats.dropped, (unsigned long)input_stats.raw_dropped);
+    printf("render: %lu submitted, %lu replaced, %lu presented, %lu late ticks, %u queued, present max %luus, anim max %luns\n",
+           (unsigned long)render_stats.submitted, (unsigned long)render_stats.replaced,
+           (unsigned long)render_stats.presented, (unsigned long)render_stats.late_ticks, render_stats.queued,
+           (unsigned long)render_stats.max_present_us, (unsigned long)render_stats.max_anim_ns);
+    printf("score: last %lu frames sent, max %lu\n", (unsigned long)render_stats.last_event_frames,
+           (unsigned long)render_stats.max_event_frames);
+    printf("strips: %lu sent, %lu skipped, %lumA, %lu limited\n", (unsigned long)framebuffer_frames_sent(),
+           (unsigned long)framebuffer_frames_skipped(), (unsigned long)framebuffer_current_ma(),
+           (unsigned long)framebuffer_frames_limited());
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        led_strip_encoder_stats_t encoder_stats;
+        ESP_ERROR_CHECK(rmt_led_strip_encoder_get_stats(strip_encoders[strip], &encoder_stats));
+        printf("encode %d: %lu frames, last %luus max %luus, %lu refills\n", strip + 1,
+               (unsigned long)encoder_stats.frames,
+               (unsigned long)(encoder_stats.last_frame_cycles / esp_rom_get_cpu_ticks_per_us()),
+               (unsigned long)(encoder_stats.max_frame_cycles / esp_rom_get_cpu_ticks_per_us()),
+               (unsigned long)encoder_stats.last_frame_calls);
+    }
+    printf("buzzer: %lu played, %lu dropped, %u queued\n", (unsigned long)buzzer_stats.played,
+           (unsigned long)buzzer_stats.dropped, buzzer_stats.queued);
+    printf("persist: %lu requests, %lu writes, %lu errors, write last %luus max %luus\n",
+           (unsigned long)persist_stats.requests, (unsigned long)persist_stats.writes,
+           (unsigned long)persist_stats.errors, (unsigned long)persist_stats.last_write_us,
+           (unsigned long)persist_stats.max_write_us);
+    return 0;
+}
+
+void console_init(rmt_encoder_handle_t led_encoders[STRIP_COUNT], const history_t *history)
+{
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        strip_encoders[strip] = led_encoders[strip];
+    }
+    match_history = history;
+    esp_console_repl_t *repl = NULL;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "placar>";
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&uart_config, &repl_config, &repl));
+
+    const esp_console_cmd_t commands[] = {
+        {
+            .command = "latency",
+            .help = "Press-to-photon histograms per stage; 'latency reset' clears them",
+            .hint = "[reset]",
+            .func = &cmd_latency,
+        },
+        {
+            .command = "jitter",
+            .help = "p50/p99/max per latency stage and the core plan; 'jitter reset' clears them",
+            .hint = "[reset]",
+            .func = &cmd_jitter,
+        },
+        {
+            .command = "log",
+            .help = "Dumps the event log ring in hex, decode it with host/log_decode",
+            .func = &cmd_log,
+        },
+        {
+            .command = "history",
+            .help = "Match history, oldest first, as kept for undo",
+            .func = &cmd_history,
+        },
+        {
+            .command = "mem",
+            .help = "Free heap, boot heap use per subsystem and stack headroom per task",
+            .func = &cmd_mem,
+        },
+        {
+            .command = "power",
+            .help = "Render idle time and time spent in each power mode",
+            .func = &cmd_power,
+        },
+        {
+            .command = "stats",
+            .help = "Event, queue and frame counters",
+            .func = &cmd_stats,
+        },
+    };
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+    {
+        ESP_ERROR_CHECK(esp_console_cmd_register(&commands[i]));
+    }
+    ESP_ERROR_CHECK(esp_console_register_help_command());
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    sysmem_register_task(xTaskGetHandle("console_repl"), repl_config.task_stack_size);
+    ESP_LOGI(TAG, "Console ready, type 'help'");
+}
@@ -0,0 +1,13 @@
+#ifndef _CONSOLE_H__
+#define _CONSOLE_H__
+
+#include "driver/rmt_encoder.h"
+#include "framebuffer.h"
+#include "history.h"
+
+// Starts a REPL on the default UART console with the diagnostic commands:
+// "latency [reset]", "log", "stats" and "history". led_encoders are the strip
+// encoders, for their encode times; history is the game task's match history.
+void console_init(rmt_encoder_handle_t led_encoders[STRIP_COUNT], const history_t *history);
+
+#endif
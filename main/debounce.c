@@ -0,0 +1,29 @@
+#include "debounce.h"
+
+void debounce_init(debounce_t *debounce, int level)
+{
+    *debounce = (debounce_t){.stable_level = level};
+}
+
+bool debounce_edge(debounce_t *debounce, int64_t time_us)
+{
+    // The pin is masked while the window is open, but a late interrupt is harmless
+    if (debounce->armed)
+    {
+        return false;
+    }
+    debounce->armed = true;
+    debounce->first_edge_us = time_us;
+    return true;
+}
+
+bool debounce_settled(debounce_t *debounce, int level)
+{
+    debounce->armed = false;
+    if (level == debounce->stable_level)
+    {
+        return false;
+    }
+    debounce->stable_level = level;
+    return true;
+}
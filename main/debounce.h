@@ -0,0 +1,36 @@
+#ifndef _DEBOUNCE_H__
+#define _DEBOUNCE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Debounce of one button pin on level interrupts, without ESP-IDF so that
+// host/power_sim can run it. The pin interrupts on the level it waits for,
+// the opposite of its stable one, and that same level is what wakes the chip
+// from light sleep. The first interrupt opens a window and masks the pin, so
+// its bounces cost nothing; when the window closes the level is read,
+// reported if it changed, and the pin is armed for debounce_wait_level().
+
+typedef struct
+{
+    bool armed; // window open, pin masked
+    int stable_level;
+    int64_t first_edge_us;
+} debounce_t;
+
+void debounce_init(debounce_t *debounce, int level);
+
+// Pin interrupt at time_us. True if it opened a window: start the timer.
+bool debounce_edge(debounce_t *debounce, int64_t time_us);
+
+// Window closed with the pin at level. True if the stable level changed,
+// starting at debounce->first_edge_us. Either way the pin is to be armed again.
+bool debounce_settled(debounce_t *debounce, int level);
+
+// Level the pin interrupts (and wakes) on next
+static inline int debounce_wait_level(const debounce_t *debounce)
+{
+    return !debounce->stable_level;
+}
+
+#endif
@@ -1,8 +1,8 @@
 #ifndef _DISPLAY_H__
 #define _DISPLAY_H__
 
-#include <stdio.h>
-#include "esp_log.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 #define NO_COLOR make_rgb(0, 0, 0)
 #define COLOR_RED make_rgb(255, 0, 0)
@@ -19,155 +19,118 @@ typedef struct
     uint8_t blue;
 } rgb;
 
-typedef struct
-{
-    uint8_t led_1;
-    uint8_t led_2;
-} block;
+// Layout of a strip (see displayOrder.png for the default one): DISPLAY_DIGITS
+// 7-segment digits, most significant first, then DISPLAY_INDICATORS single
+// LEDs. Each segment is DISPLAY_SEGMENT_PIXELS LEDs in a row, and inside a
+// digit the segments are chained clockwise from the top, the middle one last.
+// Override the three numbers from the build to fit bigger boards.
+#ifndef DISPLAY_DIGITS
+#define DISPLAY_DIGITS 1
+#endif
+#ifndef DISPLAY_SEGMENT_PIXELS
+#define DISPLAY_SEGMENT_PIXELS 2
+#endif
+#ifndef DISPLAY_INDICATORS
+#define DISPLAY_INDICATORS 1
+#endif
+
+#define DIGIT_SEGMENTS 7
+#define DIGIT_LEDS (DIGIT_SEGMENTS * DISPLAY_SEGMENT_PIXELS)
+#define DISPLAY_DIGIT_LEDS (DISPLAY_DIGITS * DIGIT_LEDS)
+#define LED_NUMBERS (DISPLAY_DIGIT_LEDS + DISPLAY_INDICATORS)
+#define LED_INDICATOR(n) (DISPLAY_DIGIT_LEDS + (n))
+#define LED_SET_GAME LED_INDICATOR(0)
+
+// A glyph is the bit mask of its segments, in wiring order: one bit per
+// segment, which display_render_glyph() spreads over its DISPLAY_SEGMENT_PIXELS
+// LEDs, so the same table serves every layout
+#define TOP (1 << 0)
+#define TOP_RIGHT (1 << 1)
+#define BOT_RIGHT (1 << 2)
+#define BOT (1 << 3)
+#define BOT_LEFT (1 << 4)
+#define TOP_LEFT (1 << 5)
+#define MID (1 << 6)
+#define PERIMETER_SEGMENTS 6 // TOP to TOP_LEFT go around the digit
+
+#define GLYPH_DASH 10
+#define GLYPH_BLANK 11
+#define GLYPH_A 12
+#define GLYPH_C 13
+#define GLYPH_E 14
+#define GLYPH_F 15
+#define GLYPH_H 16
+#define GLYPH_L 17
+#define GLYPH_P 18
+#define GLYPH_U 19
+#define GLYPH_COUNT 20
+
+static const uint8_t glyphs[GLYPH_COUNT] = {
+    [0] = TOP | TOP_LEFT | TOP_RIGHT | BOT | BOT_LEFT | BOT_RIGHT,
+    [1] = TOP_RIGHT | BOT_RIGHT,
+    [2] = TOP | TOP_RIGHT | MID | BOT | BOT_LEFT,
+    [3] = TOP | TOP_RIGHT | MID | BOT | BOT_RIGHT,
+    [4] = TOP_LEFT | TOP_RIGHT | MID | BOT_RIGHT,
+    [5] = TOP | TOP_LEFT | MID | BOT | BOT_RIGHT,
+    [6] = TOP | TOP_LEFT | MID | BOT | BOT_LEFT | BOT_RIGHT,
+    [7] = TOP | TOP_RIGHT | BOT_RIGHT,
+    [8] = TOP | TOP_LEFT | TOP_RIGHT | MID | BOT | BOT_LEFT | BOT_RIGHT,
+    [9] = TOP | TOP_LEFT | TOP_RIGHT | MID | BOT | BOT_RIGHT,
+    [GLYPH_DASH] = MID,
+    [GLYPH_BLANK] = 0,
+    [GLYPH_A] = TOP | TOP_LEFT | TOP_RIGHT | MID | BOT_LEFT | BOT_RIGHT,
+    [GLYPH_C] = TOP | TOP_LEFT | BOT | BOT_LEFT,
+    [GLYPH_E] = TOP | TOP_LEFT | MID | BOT | BOT_LEFT,
+    [GLYPH_F] = TOP | TOP_LEFT | MID | BOT_LEFT,
+    [GLYPH_H] = TOP_LEFT | TOP_RIGHT | MID | BOT_LEFT | BOT_RIGHT,
+    [GLYPH_L] = TOP_LEFT | BOT | BOT_LEFT,
+    [GLYPH_P] = TOP | TOP_LEFT | TOP_RIGHT | MID | BOT_LEFT,
+    [GLYPH_U] = TOP_LEFT | TOP_RIGHT | BOT | BOT_LEFT | BOT_RIGHT,
+};
 
-typedef struct
+static inline rgb make_rgb(uint8_t red, uint8_t green, uint8_t blue)
 {
-    block top;
-    block top_left;
-    block top_right;
-    block mid;
-    block bot;
-    block bot_left;
-    block bot_right;
-} number;
-
-#define DISABLE                  \
-    {                            \
-        .led_1 = -1, .led_2 = -1 \
-    }
-#define TOP                    \
-    {                          \
-        .led_1 = 0, .led_2 = 1 \
-    }
-#define TOP_LEFT                 \
-    {                            \
-        .led_1 = 10, .led_2 = 11 \
-    }
-#define TOP_RIGHT              \
-    {                          \
-        .led_1 = 2, .led_2 = 3 \
-    }
-#define MID                      \
-    {                            \
-        .led_1 = 12, .led_2 = 13 \
-    }
-#define BOT                    \
-    {                          \
-        .led_1 = 6, .led_2 = 7 \
-    }
-#define BOT_LEFT               \
-    {                          \
-        .led_1 = 8, .led_2 = 9 \
-    }
-#define BOT_RIGHT              \
-    {                          \
-        .led_1 = 4, .led_2 = 5 \
-    }
-
-static number numbers[10] = {
-    // N = 0
-    {.top = TOP,
-     .top_left = TOP_LEFT,
-     .top_right = TOP_RIGHT,
-     .mid = DISABLE,
-     .bot = BOT,
-     .bot_left = BOT_LEFT,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 1
-    {.top = DISABLE,
-     .top_left = DISABLE,
-     .top_right = TOP_RIGHT,
-     .mid = DISABLE,
-     .bot = DISABLE,
-     .bot_left = DISABLE,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 2
-    {.top = TOP,
-     .top_left = DISABLE,
-     .top_right = TOP_RIGHT,
-     .mid = MID,
-     .bot = BOT,
-     .bot_left = BOT_LEFT,
-     .bot_right = DISABLE}
-
-    , // N = 3
-    {.top = TOP,
-     .top_left = DISABLE,
-     .top_right = TOP_RIGHT,
-     .mid = MID,
-     .bot = BOT,
-     .bot_left = DISABLE,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 4
-    {.top = DISABLE,
-     .top_left = TOP_LEFT,
-     .top_right = TOP_RIGHT,
-     .mid = MID,
-     .bot = DISABLE,
-     .bot_left = DISABLE,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 5
-    {.top = TOP,
-     .top_left = TOP_LEFT,
-     .top_right = DISABLE,
-     .mid = MID,
-     .bot = BOT,
-     .bot_left = DISABLE,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 6
-    {.top = TOP,
-     .top_left = TOP_LEFT,
-     .top_right = DISABLE,
-     .mid = MID,
-     .bot = BOT,
-     .bot_left = BOT_LEFT,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 7
-    {.top = TOP,
-     .top_left = DISABLE,
-     .top_right = TOP_RIGHT,
-     .mid = DISABLE,
-     .bot = DISABLE,
-     .bot_left = DISABLE,
-     .bot_right = BOT_RIGHT}
-
-    , // N = 8
-    {.top = TOP,
-     .top_left = TOP_LEFT,
-     .top_right = TOP_RIGHT,
-     .mid = MID,
-     .bot = BOT,
-     .bot_left = BOT_LEFT,
-     .bot_right = BOT_RIGHT}
+    return (rgb){.red = red, .green = green, .blue = blue};
+}
 
-    , // N = 9
-    {.top = TOP,
-     .top_left = TOP_LEFT,
-     .top_right = TOP_RIGHT,
-     .mid = MID,
-     .bot = BOT,
-     .bot_left = DISABLE,
-     .bot_right = BOT_RIGHT}};
+static inline void display_set_pixel(uint8_t *pixels, int position, rgb color)
+{
+    // WS2812 wire order is G, R, B
+    pixels[position * 3 + 0] = color.green;
+    pixels[position * 3 + 1] = color.red;
+    pixels[position * 3 + 2] = color.blue;
+}
 
-number get_number(uint8_t num)
+// Writes every LED of one digit: lit where its segment is in the mask, off elsewhere.
+static inline void display_render_glyph(uint8_t *pixels, int digit, uint8_t mask, rgb color)
 {
-    return numbers[num];
+    int position = digit * DIGIT_LEDS;
+    for (int segment = 0; segment < DIGIT_SEGMENTS; segment++, mask >>= 1)
+    {
+        rgb segment_color = (mask & 1) ? color : NO_COLOR;
+        for (int pixel = 0; pixel < DISPLAY_SEGMENT_PIXELS; pixel++, position++)
+        {
+            display_set_pixel(pixels, position, segment_color);
+        }
+    }
 }
 
-static inline rgb make_rgb(uint8_t red, uint8_t green, uint8_t blue)
+// Writes value over all the digits, right-aligned without leading zeros; a
+// value that does not fit shows as dashes. Indicator LEDs are left untouched.
+static inline void display_render_number(uint8_t *pixels, unsigned value, rgb color)
 {
-    return (rgb){.red = red, .green = green, .blue = blue};
+    unsigned limit = 1;
+    for (int digit = 0; digit < DISPLAY_DIGITS; digit++)
+    {
+        limit *= 10;
+    }
+    bool fits = value < limit;
+    for (int digit = DISPLAY_DIGITS - 1; digit >= 0; digit--)
+    {
+        uint8_t glyph = !fits ? GLYPH_DASH : (value || digit == DISPLAY_DIGITS - 1) ? value % 10 : GLYPH_BLANK;
+        display_render_glyph(pixels, digit, glyphs[glyph], color);
+        value /= 10;
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,148 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "sched.h"
+#include "sysmem.h"
+#include "eventlog.h"
+
+#define EVENTLOG_MAGIC 0x50474c31 // "PGL1"
+#define EVENTLOG_TASK_STACK 3072
+#define EVENTLOG_LINE 160
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t head; // records reserved since the ring was created, free running
+    uint32_t boots;
+    eventlog_record_t records[EVENTLOG_RECORDS];
+} eventlog_ring_t;
+
+static const char *TAG = "eventlog";
+// Not zeroed at boot: what the previous boot wrote is still here after a software reset
+static __NOINIT_ATTR eventlog_ring_t ring;
+static uint32_t drained = 0; // next record the drain task prints
+static TaskHandle_t drain_task = NULL;
+
+void eventlog_write(uint16_t id, uint16_t arg0, uint32_t arg1)
+{
+    uint32_t index = __atomic_fetch_add(&ring.head, 1, __ATOMIC_RELAXED);
+    eventlog_record_t *record = &ring.records[index % EVENTLOG_RECORDS];
+    // seq is 0 while the record is being filled, so readers never take a half-written one
+    __atomic_store_n(&record->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    record->time_ms = esp_timer_get_time() / 1000;
+    record->id = id;
+    record->arg0 = arg0;
+    record->arg1 = arg1;
+    __atomic_store_n(&record->seq, index + 1, __ATOMIC_RELEASE);
+    // The drain task sleeps until there is something to print; before it exists it drains on start
+    if (drain_task)
+    {
+        xTaskNotifyGive(drain_task);
+    }
+}
+
+// Copies the record at index; returns its seq as seen, index + 1 when the copy is good
+static uint32_t eventlog_read(uint32_t index, eventlog_record_t *out)
+{
+    const eventlog_record_t *record = &ring.records[index % EVENTLOG_RECORDS];
+    uint32_t seq = __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE);
+    if (seq != index + 1)
+    {
+        return seq;
+    }
+    out->time_ms = record->time_ms;
+    out->id = record->id;
+    out->arg0 = record->arg0;
+    out->arg1 = record->arg1;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    // Overwritten while copying
+    out->seq = __atomic_load_n(&record->seq, __ATOMIC_RELAXED);
+    return out->seq;
+}
+
+static void eventlog_print(const eventlog_record_t *record)
+{
+    char line[EVENTLOG_LINE];
+    eventlog_format(record, line, sizeof(line));
+    printf("%s\n", line);
+}
+
+static void eventlog_task(void *arg)
+{
+    eventlog_record_t record;
+    while (1)
+    {
+        uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+        uint32_t lost = 0;
+        if (head - drained > EVENTLOG_RECORDS)
+        {
+            lost = head - drained - EVENTLOG_RECORDS;
+            drained = head - EVENTLOG_RECORDS;
+        }
+        while (drained != head)
+        {
+            uint32_t seq = eventlog_read(drained, &record);
+            if (seq == 0)
+            {
+                break; // still being written, its writer notifies when done
+            }
+            if (seq != drained + 1)
+            {
+                lost++;
+            }
+            else
+            {
+                eventlog_print(&record);
+            }
+            drained++;
+        }
+        if (lost)
+        {
+            eventlog_print(&(eventlog_record_t){.seq = drained, .time_ms = esp_timer_get_time() / 1000, .id = EVENTLOG_LOST, .arg1 = lost});
+        }
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+void eventlog_init(void)
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+    if (ring.magic != EVENTLOG_MAGIC || reason == ESP_RST_POWERON)
+    {
+        memset(&ring, 0, sizeof(ring));
+        ring.magic = EVENTLOG_MAGIC;
+    }
+    else
+    {
+        // The drain task starts with what was in the ring before the reset
+        uint32_t kept = ring.head < EVENTLOG_RECORDS ? ring.head : EVENTLOG_RECORDS;
+        drained = ring.head - kept;
+        ESP_LOGI(TAG, "Reset reason %d, replaying the last %lu events before it", reason, (unsigned long)kept);
+    }
+    ring.boots++;
+    eventlog_write(EVENTLOG_BOOT, reason, ring.boots);
+    drain_task = sysmem_task(eventlog_task, "eventlog", EVENTLOG_TASK_STACK, NULL, SCHED_EVENTLOG_PRIORITY,
+                                      SCHED_CORE(SCHED_CORE_OUTPUT));
+}
+
+void eventlog_dump_hex(void)
+{
+    uint32_t head = __atomic_load_n(&ring.head, __ATOMIC_ACQUIRE);
+    uint32_t first = head < EVENTLOG_RECORDS ? 0 : head - EVENTLOG_RECORDS;
+    eventlog_record_t record;
+    for (uint32_t index = first; index != head; index++)
+    {
+        if (eventlog_read(index, &record) == index + 1)
+        {
+            printf("EVLOG %08lx%08lx%04x%04x%08lx\n", (unsigned long)record.seq, (unsigned long)record.time_ms,
+                   record.id, record.arg0, (unsigned long)record.arg1);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef _EVENTLOG_H__
+#define _EVENTLOG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary event log: hot paths write fixed 16-byte records into a lock-free
+// ring in no-init RAM, a low-priority task woken by each write formats them on
+// the console later, and sleeps while nothing is logged.
+// The ring survives software resets (panic, watchdog, esp_restart), so the
+// last EVENTLOG_RECORDS events before one are printed again at boot.
+
+#define EVENTLOG_RECORDS 64 // power of two
+
+#define EVENTLOG_BOOT 1    // arg0 reset reason, arg1 boots seen by this ring
+#define EVENTLOG_PRESS 2   // arg0 button, arg1 debounce time in us
+#define EVENTLOG_DROP 3    // arg0 button, arg1 presses dropped so far
+#define EVENTLOG_SCORE 4   // arg0 rules_pack() of the new state, arg1 effects | team << 8 | rules time in us << 16
+#define EVENTLOG_PHOTON 5  // arg0 strips sent, arg1 press-to-photon time in us
+#define EVENTLOG_LOST 6    // arg1 records overwritten before the drain task saw them
+#define EVENTLOG_UNDO 7    // arg0 rules_pack() of the state restored, arg1 points left to undo
+#define EVENTLOG_GESTURE 8 // arg0 GESTURE_* kind | button << 8, arg1 duration in ms
+#define EVENTLOG_FRAMES 9  // arg0 frames presented, arg1 strip transmissions, for one score event
+
+typedef struct
+{
+    uint32_t seq; // 1 + index of the record since the ring was created, 0 while it is being written
+    uint32_t time_ms;
+    uint16_t id; // EVENTLOG_*
+    uint16_t arg0;
+    uint32_t arg1;
+} eventlog_record_t;
+
+// Restores or clears the ring and starts the drain task.
+void eventlog_init(void);
+
+// Safe from any task, never blocks: when the ring is full the oldest record is overwritten.
+void eventlog_write(uint16_t id, uint16_t arg0, uint32_t arg1);
+
+// Prints the ring as "EVLOG <32 hex digits>" lines, for host/log_decode.
+void eventlog_dump_hex(void);
+
+// Text form of a record, shared with host/log_decode; returns the snprintf length.
+int eventlog_format(const eventlog_record_t *record, char *buffer, size_t size);
+
+#endif
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include "rules.h"
+#include "eventlog.h"
+#include "gesture.h"
+
+static const char *gesture_names[GESTURE_KINDS] = {"none", "press", "double press", "long press", "chord", "long chord"};
+
+static const char *team_name(uint8_t team)
+{
+    return team == RULES_TEAM_BLUE ? "blue" : "red";
+}
+
+int eventlog_format(const eventlog_record_t *record, char *buffer, size_t size)
+{
+    int n = snprintf(buffer, size, "[%6lu.%03lu] #%lu ", (unsigned long)(record->time_ms / 1000),
+                     (unsigned long)(record->time_ms % 1000), (unsigned long)record->seq);
+    if (n < 0 || (size_t)n >= size)
+    {
+        return n;
+    }
+    buffer += n;
+    size -= n;
+
+    switch (record->id)
+    {
+    case EVENTLOG_BOOT:
+        return n + snprintf(buffer, size, "BOOT reset reason %u, boot %lu", record->arg0, (unsigned long)record->arg1);
+    case EVENTLOG_PRESS:
+        return n + snprintf(buffer, size, "PRESS button %u, debounce %luus", record->arg0 + 1, (unsigned long)record->arg1);
+    case EVENTLOG_DROP:
+        return n + snprintf(buffer, size, "DROP button %u, queue full (%lu dropped)", record->arg0 + 1, (unsigned long)record->arg1);
+    case EVENTLOG_SCORE:
+    {
+        rules_state_t state = rules_unpack(record->arg0);
+        uint8_t effects = record->arg1 & 0xff;
+        uint8_t team = (record->arg1 >> 8) & 0xff;
+        return n + snprintf(buffer, size, "SCORE 1(%u) - SCORE 2(%u) | sets %u-%u | %s%s%s%s%s%s(%s) rules %luus%s",
+                            state.score[RULES_TEAM_BLUE], state.score[RULES_TEAM_RED], state.sets[RULES_TEAM_BLUE],
+                            state.sets[RULES_TEAM_RED], effects & RULES_EFFECT_POINT ? "point " : "",
+                            effects & RULES_EFFECT_SET ? "set " : "", effects & RULES_EFFECT_FINAL ? "final " : "",
+                            effects & RULES_EFFECT_SWAP ? "swap " : "", effects & RULES_EFFECT_DEUCE ? "deuce " : "",
+                            effects & RULES_EFFECT_END ? "end " : "", team_name(team), (unsigned long)(record->arg1 >> 16),
+                            effects & RULES_EFFECT_END ? " ACABOUUUUUUUU!!!" : "");
+    }
+    case EVENTLOG_PHOTON:
+        return n + snprintf(buffer, size, "PHOTON strips 0x%x, %luus after the press", record->arg0, (unsigned long)record->arg1);
+    case EVENTLOG_LOST:
+        return n + snprintf(buffer, size, "LOST %lu records", (unsigned long)record->arg1);
+    case EVENTLOG_UNDO:
+    {
+        rules_state_t state = rules_unpack(record->arg0);
+        return n + snprintf(buffer, size, "UNDO back to %u-%u | sets %u-%u, %lu more possible", state.score[RULES_TEAM_BLUE],
+                            state.score[RULES_TEAM_RED], state.sets[RULES_TEAM_BLUE], state.sets[RULES_TEAM_RED],
+                            (unsigned long)record->arg1);
+    }
+    case EVENTLOG_GESTURE:
+        return n + snprintf(buffer, size, "GESTURE %s, button %u, %lums",
+                            (record->arg0 & 0xff) < GESTURE_KINDS ? gesture_names[record->arg0 & 0xff] : "?",
+                            (record->arg0 >> 8) + 1, (unsigned long)record->arg1);
+    case EVENTLOG_FRAMES:
+        return n + snprintf(buffer, size, "FRAMES %lu sent, %u presented for the score", (unsigned long)record->arg1,
+                            record->arg0);
+    default:
+        return n + snprintf(buffer, size, "event %u (%u, %lu)", record->id, record->arg0, (unsigned long)record->arg1);
+    }
+}
@@ -0,0 +1,266 @@
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "soc/soc_caps.h"
+#include "framebuffer.h"
+
+static rmt_channel_handle_t strip_channels[STRIP_COUNT] = {NULL};
+static rmt_encoder_handle_t strip_encoders[STRIP_COUNT] = {NULL}; // one per channel, see led_strip_encoder.h
+static gpio_num_t strip_pins[STRIP_COUNT];
+static frame_t staged = {0};
+// Last frame that actually went down the wire, per strip
+static frame_t committed = {0};
+static bool strip_committed_valid[STRIP_COUNT] = {false};
+static uint32_t frames_sent = 0;
+static uint32_t frames_skipped = 0;
+static bool strips_enabled = true; // see framebuffer_release()
+
+// Output stage: brightness then gamma through one table per strip, then the current limiter
+static const uint8_t gamma_table[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+static uint8_t strip_brightness[STRIP_COUNT] = {255, 255};
+static uint8_t strip_lut_brightness[STRIP_COUNT] = {0}; // brightness the table was built for
+static uint8_t strip_lut[STRIP_COUNT][256];
+static bool strip_lut_valid[STRIP_COUNT] = {false};
+static uint32_t current_limit_ma = 0;
+static uint32_t current_ma = 0;
+static uint32_t frames_limited = 0;
+static frame_t output = {0};
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+// Both strips start on the same RMT clock edge, once each has a transaction
+static rmt_sync_manager_handle_t strip_sync = NULL;
+#endif
+
+void framebuffer_init(rmt_channel_handle_t channels[STRIP_COUNT], rmt_encoder_handle_t encoders[STRIP_COUNT],
+                      const gpio_num_t pins[STRIP_COUNT])
+{
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        strip_channels[strip] = channels[strip];
+        strip_encoders[strip] = encoders[strip];
+        strip_pins[strip] = pins[strip];
+        // The pad keeps its RMT output configuration in light sleep instead of the sleep one
+        ESP_ERROR_CHECK(gpio_sleep_sel_dis(pins[strip]));
+        // The strips hold whatever they showed before reset, so the first commit always goes out
+        strip_committed_valid[strip] = false;
+    }
+
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+    rmt_sync_manager_config_t sync_config = {
+        .tx_channel_array = strip_channels,
+        .array_size = STRIP_COUNT,
+    };
+    ESP_ERROR_CHECK(rmt_new_sync_manager(&sync_config, &strip_sync));
+#endif
+}
+
+void framebuffer_set(int strip, int position, rgb color)
+{
+    display_set_pixel(staged.pixels[strip], position, color);
+}
+
+void framebuffer_glyph(int strip, uint8_t mask, rgb color)
+{
+    for (int digit = 0; digit < DISPLAY_DIGITS; digit++)
+    {
+        display_render_glyph(staged.pixels[strip], digit, mask, color);
+    }
+}
+
+void framebuffer_number(int strip, unsigned value, rgb color)
+{
+    display_render_number(staged.pixels[strip], value, color);
+}
+
+static bool strip_differs(const frame_t *frame, int strip)
+{
+    return !strip_committed_valid[strip] ||
+           memcmp(frame->pixels[strip], committed.pixels[strip], sizeof(frame->pixels[strip])) != 0;
+}
+
+static void build_lut(int strip)
+{
+    uint8_t brightness = strip_brightness[strip];
+    if (strip_lut_valid[strip] && strip_lut_brightness[strip] == brightness)
+    {
+        return;
+    }
+    for (int value = 0; value < 256; value++)
+    {
+        strip_lut[strip][value] = gamma_table[value * brightness / 255];
+    }
+    strip_lut_brightness[strip] = brightness;
+    strip_lut_valid[strip] = true;
+}
+
+// Wire bytes of a frame after brightness, gamma and the current budget
+static void apply_output(const frame_t *frame)
+{
+    uint32_t channel_sum = 0;
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        build_lut(strip);
+        for (int i = 0; i < LED_NUMBERS * 3; i++)
+        {
+            uint8_t value = strip_lut[strip][frame->pixels[strip][i]];
+            output.pixels[strip][i] = value;
+            channel_sum += value;
+        }
+    }
+
+    const uint32_t idle_ma = STRIP_COUNT * LED_NUMBERS * FRAMEBUFFER_LED_IDLE_MA;
+    current_ma = idle_ma + channel_sum * FRAMEBUFFER_CHANNEL_MA / 255;
+    if (!current_limit_ma || current_ma <= current_limit_ma)
+    {
+        return;
+    }
+
+    // Scale every channel by budget / draw, in 8.8 fixed point
+    uint32_t budget_ma = current_limit_ma > idle_ma ? current_limit_ma - idle_ma : 0;
+    uint32_t scale = budget_ma * 255 * 256 / (channel_sum * FRAMEBUFFER_CHANNEL_MA);
+    channel_sum = 0;
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        for (int i = 0; i < LED_NUMBERS * 3; i++)
+        {
+            output.pixels[strip][i] = output.pixels[strip][i] * scale >> 8;
+            channel_sum += output.pixels[strip][i];
+        }
+    }
+    current_ma = idle_ma + channel_sum * FRAMEBUFFER_CHANNEL_MA / 255;
+    frames_limited++;
+}
+
+uint32_t framebuffer_present(const frame_t *in)
+{
+    apply_output(in);
+    const frame_t *frame = &output;
+    uint32_t dirty = 0;
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        if (strip_differs(frame, strip))
+        {
+            dirty |= 1u << strip;
+        }
+    }
+    if (!dirty)
+    {
+        frames_skipped += STRIP_COUNT;
+        return 0;
+    }
+
+    if (!strips_enabled)
+    {
+        for (int strip = 0; strip < STRIP_COUNT; strip++)
+        {
+            ESP_ERROR_CHECK(gpio_hold_dis(strip_pins[strip]));
+            ESP_ERROR_CHECK(rmt_enable(strip_channels[strip]));
+        }
+        strips_enabled = true;
+    }
+
+    uint32_t send = dirty;
+#if SOC_RMT_SUPPORT_TX_SYNCHRO
+    // A synchronized channel only starts when all of them have data, so clean strips are resent too
+    send = (1u << STRIP_COUNT) - 1;
+    ESP_ERROR_CHECK(rmt_sync_reset(strip_sync));
+#endif
+
+    // Start every strip, then wait once for all of them: both update in the time of one
+    rmt_transmit_config_t tx_config = {
+        .loop_count = 0, // no transfer loop
+    };
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        if (send & (1u << strip))
+        {
+            ESP_ERROR_CHECK(rmt_transmit(strip_channels[strip], strip_encoders[strip], frame->pixels[strip], sizeof(frame->pixels[strip]), &tx_config));
+        }
+        else
+        {
+            frames_skipped++;
+        }
+    }
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        if (send & (1u << strip))
+        {
+            ESP_ERROR_CHECK(rmt_tx_wait_all_done(strip_channels[strip], portMAX_DELAY));
+            memcpy(committed.pixels[strip], frame->pixels[strip], sizeof(frame->pixels[strip]));
+            strip_committed_valid[strip] = true;
+            frames_sent++;
+        }
+    }
+    return dirty;
+}
+
+void framebuffer_release(void)
+{
+    if (!strips_enabled)
+    {
+        return;
+    }
+    // framebuffer_present() waits for its transmissions, so nothing is cut short
+    // here and every line rests at the low level that ends a reset code
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        ESP_ERROR_CHECK(rmt_disable(strip_channels[strip]));
+        ESP_ERROR_CHECK(gpio_hold_en(strip_pins[strip]));
+    }
+    strips_enabled = false;
+}
+
+uint32_t framebuffer_commit_all(void)
+{
+    return framebuffer_present(&staged);
+}
+
+void framebuffer_snapshot(frame_t *frame)
+{
+    *frame = staged;
+}
+
+uint32_t framebuffer_frames_sent(void)
+{
+    return frames_sent;
+}
+
+uint32_t framebuffer_frames_skipped(void)
+{
+    return frames_skipped;
+}
+
+void framebuffer_set_brightness(int strip, uint8_t brightness)
+{
+    strip_brightness[strip] = brightness;
+}
+
+void framebuffer_set_current_limit(uint32_t limit_ma)
+{
+    current_limit_ma = limit_ma;
+}
+
+uint32_t framebuffer_current_ma(void)
+{
+    return current_ma;
+}
+
+uint32_t framebuffer_frames_limited(void)
+{
+    return frames_limited;
+}
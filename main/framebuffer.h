@@ -0,0 +1,68 @@
+#ifndef _FRAMEBUFFER_H__
+#define _FRAMEBUFFER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+#include "display.h"
+
+#define STRIP_TEAM_1 0
+#define STRIP_TEAM_2 1
+#define STRIP_COUNT 2
+
+// WS2812 current model for the limiter
+#define FRAMEBUFFER_CHANNEL_MA 20 // one color channel at full duty
+#define FRAMEBUFFER_LED_IDLE_MA 1 // driver of a dark LED
+
+// Wire bytes of every strip
+typedef struct
+{
+    uint8_t pixels[STRIP_COUNT][LED_NUMBERS * 3];
+} frame_t;
+
+// Pixels are staged in RAM and only go down the wire on framebuffer_commit_all(),
+// so a whole display update costs one RMT transmission per strip. The strips
+// are transmitted in parallel, and in lockstep where the RMT supports it, so
+// every channel comes with its own encoder and the data pin it drives. The
+// channels are handed over enabled (rmt_enable).
+void framebuffer_init(rmt_channel_handle_t channels[STRIP_COUNT], rmt_encoder_handle_t encoders[STRIP_COUNT],
+                      const gpio_num_t pins[STRIP_COUNT]);
+void framebuffer_set(int strip, int position, rgb color);
+// Renders a glyph mask from display.h on every digit of a strip.
+void framebuffer_glyph(int strip, uint8_t mask, rgb color);
+// Renders a number over the digits of a strip, see display_render_number().
+void framebuffer_number(int strip, unsigned value, rgb color);
+
+// Transmits the dirty strips and returns a bit mask (1 << strip) of them.
+uint32_t framebuffer_commit_all(void);
+
+// Copies the staged pixels of every strip, e.g. to hand them to another task.
+void framebuffer_snapshot(frame_t *frame);
+// Transmits the strips of a frame that differ from what they show, like
+// framebuffer_commit_all() does with the staged pixels, which it leaves alone.
+// Frames go out through brightness, a 2.2 gamma and the current limiter.
+uint32_t framebuffer_present(const frame_t *frame);
+
+// Disables the RMT channels until the next transmission. An enabled channel
+// holds a power management lock that keeps the APB clock up and the chip out
+// of light sleep; the strips keep showing their last frame without it. The
+// data pins are latched at the idle low level meanwhile, so nothing the pads
+// do while the chip sleeps or wakes reaches the strips as a bit.
+void framebuffer_release(void);
+
+// 255 is full brightness; takes effect on the next commit.
+void framebuffer_set_brightness(int strip, uint8_t brightness);
+// Frames whose estimated draw, both strips together, goes over limit_ma are
+// dimmed to fit it; 0 disables the limiter.
+void framebuffer_set_current_limit(uint32_t limit_ma);
+// Estimated draw of the last frame presented, after limiting.
+uint32_t framebuffer_current_ma(void);
+// Frames dimmed by the limiter since boot.
+uint32_t framebuffer_frames_limited(void);
+
+// Frames transmitted / skipped as unchanged since boot, on all strips.
+uint32_t framebuffer_frames_sent(void);
+uint32_t framebuffer_frames_skipped(void);
+
+#endif
@@ -0,0 +1,118 @@
+#include <stddef.h>
+#include "gesture.h"
+
+static int gesture_emit(gesture_t *out, int count, uint8_t kind, uint8_t button, int64_t timestamp_us, int64_t started_us)
+{
+    out[count] = (gesture_t){.kind = kind, .button = button, .timestamp_us = timestamp_us, .started_us = started_us};
+    return count + 1;
+}
+
+void gesture_init(gesture_classifier_t *classifier, const gesture_config_t *config)
+{
+    *classifier = (gesture_classifier_t){.config = *config};
+}
+
+static int gesture_release_chord(gesture_classifier_t *classifier, uint8_t button, int64_t time_us, gesture_t *out)
+{
+    gesture_button_t *other = &classifier->buttons[button ^ 1];
+    if (other->down)
+    {
+        classifier->chord_end_us = time_us;
+        return 0;
+    }
+    classifier->buttons[button].chord = false;
+    other->chord = false;
+    bool held = classifier->chord_end_us - classifier->chord_start_us >= classifier->config.long_us;
+    return gesture_emit(out, 0, held ? GESTURE_CHORD_LONG : GESTURE_CHORD, classifier->chord_first, time_us,
+                        classifier->buttons[classifier->chord_first].down_us);
+}
+
+int gesture_edge(gesture_classifier_t *classifier, uint8_t button, bool down, int64_t time_us, gesture_t *out)
+{
+    gesture_button_t *self = &classifier->buttons[button];
+    gesture_button_t *other = &classifier->buttons[button ^ 1];
+
+    if (down)
+    {
+        self->down = true;
+        self->down_us = time_us;
+        if (self->pending)
+        {
+            self->second = true;
+        }
+        else if (other->down && !other->chord && !other->second && time_us - other->down_us <= classifier->config.chord_us)
+        {
+            self->chord = other->chord = true;
+            classifier->chord_first = button ^ 1;
+            classifier->chord_start_us = time_us;
+            classifier->chord_end_us = 0;
+        }
+        return 0;
+    }
+
+    if (!self->down)
+    {
+        return 0;
+    }
+    self->down = false;
+    if (self->chord)
+    {
+        return gesture_release_chord(classifier, button, time_us, out);
+    }
+
+    int count = 0;
+    bool held = time_us - self->down_us >= classifier->config.long_us;
+    if (self->second)
+    {
+        self->second = false;
+        self->pending = false;
+        if (!held)
+        {
+            return gesture_emit(out, count, GESTURE_DOUBLE, button, time_us, self->pending_down_us);
+        }
+        // A press and then a long one
+        count = gesture_emit(out, count, GESTURE_PRESS, button, self->pending_up_us, self->pending_down_us);
+    }
+    if (held)
+    {
+        return gesture_emit(out, count, GESTURE_LONG, button, time_us, self->down_us);
+    }
+    if (classifier->config.double_buttons & (1u << button))
+    {
+        self->pending = true;
+        self->pending_down_us = self->down_us;
+        self->pending_up_us = time_us;
+        return count;
+    }
+    return gesture_emit(out, count, GESTURE_PRESS, button, time_us, self->down_us);
+}
+
+int gesture_expire(gesture_classifier_t *classifier, int64_t now_us, gesture_t *out)
+{
+    int count = 0;
+    for (uint8_t button = 0; button < GESTURE_BUTTONS; button++)
+    {
+        gesture_button_t *self = &classifier->buttons[button];
+        // A second press already started keeps the first one waiting until it is released
+        if (self->pending && !self->second && now_us - self->pending_up_us >= classifier->config.double_us)
+        {
+            self->pending = false;
+            count = gesture_emit(out, count, GESTURE_PRESS, button, self->pending_up_us, self->pending_down_us);
+        }
+    }
+    return count;
+}
+
+int64_t gesture_deadline(const gesture_classifier_t *classifier)
+{
+    int64_t deadline = INT64_MAX;
+    for (uint8_t button = 0; button < GESTURE_BUTTONS; button++)
+    {
+        const gesture_button_t *self = &classifier->buttons[button];
+        if (self->pending && !self->second && self->pending_up_us + classifier->config.double_us < deadline)
+        {
+            deadline = self->pending_up_us + classifier->config.double_us;
+        }
+    }
+    return deadline;
+}
@@ -0,0 +1,77 @@
+#ifndef _GESTURE_H__
+#define _GESTURE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Turns the debounced edges of the two buttons into gestures, from their
+// timestamps only, so it also runs on the host.
+//
+// A release is a GESTURE_PRESS right away, or a GESTURE_LONG when the button
+// was held config->long_us. Both buttons going down within config->chord_us
+// of each other make one GESTURE_CHORD (or GESTURE_CHORD_LONG) when the last
+// one is released. Double presses are opt-in per button (double_buttons):
+// only those buttons hold their single press back for config->double_us to
+// see if a second one follows.
+
+#define GESTURE_BUTTONS 2
+
+#define GESTURE_NONE 0
+#define GESTURE_PRESS 1
+#define GESTURE_DOUBLE 2
+#define GESTURE_LONG 3
+#define GESTURE_CHORD 4      // button is the one pressed first
+#define GESTURE_CHORD_LONG 5 // both held together for long_us
+#define GESTURE_KINDS 6
+
+#define GESTURE_MAX_OUT 2 // gestures one call can complete
+
+typedef struct
+{
+    uint32_t long_us;
+    uint32_t chord_us;
+    uint32_t double_us;
+    uint8_t double_buttons; // bit per button
+} gesture_config_t;
+
+typedef struct
+{
+    uint8_t kind; // GESTURE_*
+    uint8_t button;
+    int64_t timestamp_us; // release that completed the gesture
+    int64_t started_us;   // first press of the gesture
+} gesture_t;
+
+typedef struct
+{
+    bool down;
+    bool chord;   // part of the chord in progress
+    bool second;  // this press follows a pending one inside the double window
+    bool pending; // released single press waiting for the double window
+    int64_t down_us;
+    int64_t pending_down_us;
+    int64_t pending_up_us;
+} gesture_button_t;
+
+typedef struct
+{
+    gesture_config_t config;
+    gesture_button_t buttons[GESTURE_BUTTONS];
+    uint8_t chord_first;
+    int64_t chord_start_us; // both down since
+    int64_t chord_end_us;   // first of the two released, 0 while both are down
+} gesture_classifier_t;
+
+void gesture_init(gesture_classifier_t *classifier, const gesture_config_t *config);
+
+// Feeds one debounced edge; call gesture_expire(time_us) first. Returns how
+// many gestures were written to out (at most GESTURE_MAX_OUT).
+int gesture_edge(gesture_classifier_t *classifier, uint8_t button, bool down, int64_t time_us, gesture_t *out);
+
+// Completes the single presses whose double window is over by now_us.
+int gesture_expire(gesture_classifier_t *classifier, int64_t now_us, gesture_t *out);
+
+// When gesture_expire has something to do next, INT64_MAX if never.
+int64_t gesture_deadline(const gesture_classifier_t *classifier);
+
+#endif
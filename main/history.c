@@ -0,0 +1,94 @@
+#include <string.h>
+#include "history.h"
+
+static void history_begin(history_t *history)
+{
+    __atomic_store_n(&history->version, history->version + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void history_end(history_t *history)
+{
+    __atomic_store_n(&history->version, history->version + 1, __ATOMIC_RELEASE);
+}
+
+static void history_add(history_t *history, uint16_t entry)
+{
+    history_begin(history);
+    history->entries[history->head % HISTORY_DEPTH] = entry;
+    history->head++;
+    if (history->count < HISTORY_DEPTH)
+    {
+        history->count++;
+    }
+    history_end(history);
+}
+
+void history_reset(history_t *history)
+{
+    history_begin(history);
+    history->head = 0;
+    history->count = 0;
+    history_end(history);
+}
+
+void history_start(history_t *history, const rules_state_t *state)
+{
+    history_add(history, rules_pack(state) | HISTORY_ENTRY_START);
+}
+
+void history_push(history_t *history, const rules_state_t *state, uint8_t side)
+{
+    history_add(history, rules_pack(state) | (side == RULES_SIDE_2 ? HISTORY_ENTRY_SIDE : 0));
+}
+
+bool history_undo(history_t *history, rules_state_t *state)
+{
+    // The newest entry is the current state, the one before it is where undo goes;
+    // a match never goes back past its start, into the match before a restart
+    if (history->count < 2 || history->entries[(history->head - 1) % HISTORY_DEPTH] & HISTORY_ENTRY_START)
+    {
+        return false;
+    }
+    history_begin(history);
+    history->head--;
+    history->count--;
+    history_end(history);
+    *state = rules_unpack(history->entries[(history->head - 1) % HISTORY_DEPTH] & HISTORY_ENTRY_STATE);
+    return true;
+}
+
+uint32_t history_undoable(const history_t *history)
+{
+    uint32_t points = 0;
+    while (points + 1 < history->count &&
+           !(history->entries[(history->head - 1 - points) % HISTORY_DEPTH] & HISTORY_ENTRY_START))
+    {
+        points++;
+    }
+    return points;
+}
+
+size_t history_export(const history_t *history, uint16_t *out, size_t max)
+{
+    size_t count = history->count < max ? history->count : max;
+    for (size_t i = 0; i < count; i++)
+    {
+        out[i] = history->entries[(history->head - count + i) % HISTORY_DEPTH];
+    }
+    return count;
+}
+
+void history_copy(const history_t *history, history_t *out)
+{
+    uint32_t version;
+    do
+    {
+        version = __atomic_load_n(&history->version, __ATOMIC_ACQUIRE);
+        memcpy(out->entries, history->entries, sizeof(out->entries));
+        out->head = history->head;
+        out->count = history->count;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((version & 1) || version != __atomic_load_n(&history->version, __ATOMIC_RELAXED));
+    out->version = version;
+}
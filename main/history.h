@@ -0,0 +1,51 @@
+#ifndef _HISTORY_H__
+#define _HISTORY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rules.h"
+
+// Match history as a ring of 2-byte entries: the rules_pack() state after
+// every point, plus the side that scored it. Undo drops the newest entry and
+// hands back the one before, so it costs the same at any depth and never
+// allocates. The oldest entries are overwritten after HISTORY_DEPTH points.
+
+#define HISTORY_DEPTH 128 // power of two
+
+#define HISTORY_ENTRY_STATE 0x0fff    // rules_pack() of the state
+#define HISTORY_ENTRY_SIDE (1 << 12)  // set when RULES_SIDE_2 scored
+#define HISTORY_ENTRY_START (1 << 13) // match (re)started, nobody scored
+
+typedef struct
+{
+    uint16_t entries[HISTORY_DEPTH];
+    uint32_t head;    // entries pushed since history_reset, free running
+    uint32_t count;   // entries that can still be read, at most HISTORY_DEPTH
+    uint32_t version; // odd while an entry is being changed, see history_copy
+} history_t;
+
+void history_reset(history_t *history);
+
+// Records the first state of a match.
+void history_start(history_t *history, const rules_state_t *state);
+
+// Records the state after a point scored on side.
+void history_push(history_t *history, const rules_state_t *state, uint8_t side);
+
+// Drops the newest entry and returns the state before it; false, with
+// *state untouched, when there is nothing left to undo or the newest entry is
+// the start of a match. Restarts and format changes begin with one, so undo
+// never goes back into an earlier match or format.
+bool history_undo(history_t *history, rules_state_t *state);
+
+// Points history_undo() can still take back in the current match.
+uint32_t history_undoable(const history_t *history);
+
+// Entries oldest first; returns how many were written to out.
+size_t history_export(const history_t *history, uint16_t *out, size_t max);
+
+// Consistent copy of a history being changed by another task.
+void history_copy(const history_t *history, history_t *out);
+
+#endif
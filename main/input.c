@@ -0,0 +1,175 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "driver/gpio.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "debounce.h"
+#include "eventlog.h"
+#include "latency.h"
+#include "sched.h"
+#include "sysmem.h"
+#include "input.h"
+
+#define INPUT_QUEUE_DEPTH 16
+#define INPUT_TASK_STACK 3072
+
+#define INPUT_RAW_EDGE 0    // pin reached the level it waited for, from the GPIO ISR
+#define INPUT_RAW_SETTLED 1 // debounce window elapsed, from the esp_timer
+
+typedef struct
+{
+    uint8_t kind;
+    uint8_t button;
+    int64_t timestamp_us;
+} input_raw_t;
+
+static const char *TAG = "input";
+static input_config_t input_config;
+static QueueHandle_t input_queue = NULL;
+static esp_timer_handle_t debounce_timers[INPUT_BUTTON_COUNT] = {NULL};
+static input_stats_t stats = {0};
+
+static void IRAM_ATTR input_gpio_isr(void *arg)
+{
+    BaseType_t woken = pdFALSE;
+    input_raw_t raw = {
+        .kind = INPUT_RAW_EDGE,
+        .button = (uint8_t)(uintptr_t)arg,
+        .timestamp_us = esp_timer_get_time(),
+    };
+    // Level interrupt: masked until the input task arms the pin again
+    gpio_intr_disable(input_config.gpio_num[raw.button]);
+    if (xQueueSendFromISR(input_queue, &raw, &woken) != pdTRUE)
+    {
+        stats.raw_dropped++;
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+static void input_debounce_expired(void *arg)
+{
+    input_raw_t raw = {
+        .kind = INPUT_RAW_SETTLED,
+        .button = (uint8_t)(uintptr_t)arg,
+        .timestamp_us = esp_timer_get_time(),
+    };
+    if (xQueueSend(input_queue, &raw, 0) != pdTRUE)
+    {
+        stats.raw_dropped++;
+    }
+}
+
+// Interrupt, and light sleep wake-up, on the level the button waits for
+static void input_arm(int button, const debounce_t *debounce)
+{
+    int gpio_num = input_config.gpio_num[button];
+    ESP_ERROR_CHECK(gpio_wakeup_enable(gpio_num, debounce_wait_level(debounce) ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL));
+    ESP_ERROR_CHECK(gpio_intr_enable(gpio_num));
+}
+
+// The GPIO interrupt is allocated on the core that installs the ISR service, here the input task's
+static void input_install_isr(debounce_t *debounce)
+{
+    ESP_ERROR_CHECK(gpio_install_isr_service(0));
+    for (int button = 0; button < INPUT_BUTTON_COUNT; button++)
+    {
+        debounce_init(&debounce[button], gpio_get_level(input_config.gpio_num[button]));
+        ESP_ERROR_CHECK(gpio_isr_handler_add(input_config.gpio_num[button], input_gpio_isr, (void *)(uintptr_t)button));
+        input_arm(button, &debounce[button]);
+    }
+    ESP_ERROR_CHECK(esp_sleep_enable_gpio_wakeup());
+}
+
+static void input_task(void *arg)
+{
+    debounce_t debounce[INPUT_BUTTON_COUNT];
+    input_install_isr(debounce);
+
+    input_raw_t raw;
+    while (1)
+    {
+        // Blocks until an edge or a debounce expiry, so the task costs nothing between points
+        if (xQueueReceive(input_queue, &raw, portMAX_DELAY) != pdTRUE)
+        {
+            continue;
+        }
+
+        debounce_t *button = &debounce[raw.button];
+        if (raw.kind == INPUT_RAW_EDGE)
+        {
+            // The pin stays masked through the window, so its bounces never get here;
+            // nor does it wake the chip, the timer does when the window closes
+            if (debounce_edge(button, raw.timestamp_us))
+            {
+                gpio_wakeup_disable(input_config.gpio_num[raw.button]);
+                esp_timer_start_once(debounce_timers[raw.button], input_config.debounce_us);
+            }
+            continue;
+        }
+
+        // How long the task took to run once the window closed, i.e. its scheduling jitter
+        latency_record(LATENCY_WAKE, esp_timer_get_time() - raw.timestamp_us);
+        int level = gpio_get_level(input_config.gpio_num[raw.button]);
+        bool changed = debounce_settled(button, level);
+        input_arm(raw.button, button);
+        if (!changed)
+        {
+            continue;
+        }
+
+        input_event_t event = {
+            .button = raw.button,
+            .down = !level,
+            .timestamp_us = button->first_edge_us,
+            .queued_us = esp_timer_get_time(),
+        };
+        if (xQueueSend(input_config.queue, &event, 0) != pdTRUE)
+        {
+            stats.dropped++;
+            eventlog_write(EVENTLOG_DROP, raw.button, stats.dropped);
+        }
+        else if (level)
+        {
+            stats.presses++;
+            eventlog_write(EVENTLOG_PRESS, raw.button, event.queued_us - event.timestamp_us);
+        }
+    }
+}
+
+void input_init(const input_config_t *config)
+{
+    input_config = *config;
+    input_queue = sysmem_queue(INPUT_QUEUE_DEPTH, sizeof(input_raw_t));
+
+    uint64_t pin_mask = 0;
+    for (int button = 0; button < INPUT_BUTTON_COUNT; button++)
+    {
+        pin_mask |= 1ULL << input_config.gpio_num[button];
+
+        esp_timer_create_args_t timer_args = {
+            .callback = input_debounce_expired,
+            .arg = (void *)(uintptr_t)button,
+            .name = "debounce",
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&timer_args, &debounce_timers[button]));
+    }
+
+    gpio_config_t btn_teams_config;
+    btn_teams_config.intr_type = GPIO_INTR_DISABLE; // level interrupts, set by input_arm()
+    btn_teams_config.mode = GPIO_MODE_INPUT;
+    btn_teams_config.pin_bit_mask = pin_mask;
+    btn_teams_config.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    btn_teams_config.pull_up_en = GPIO_PULLUP_ENABLE;
+    ESP_ERROR_CHECK(gpio_config(&btn_teams_config));
+
+    ESP_LOGI(TAG, "Buttons on GPIO %d/%d, debounce %luus", input_config.gpio_num[INPUT_BUTTON_1],
+             input_config.gpio_num[INPUT_BUTTON_2], (unsigned long)input_config.debounce_us);
+    sysmem_task(input_task, "input", INPUT_TASK_STACK, NULL, SCHED_INPUT_PRIORITY, SCHED_CORE(SCHED_CORE_SCORING));
+}
+
+void input_get_stats(input_stats_t *out)
+{
+    *out = stats;
+}
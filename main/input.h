@@ -0,0 +1,43 @@
+#ifndef _INPUT_H__
+#define _INPUT_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#define INPUT_BUTTON_1 0
+#define INPUT_BUTTON_2 1
+#define INPUT_BUTTON_COUNT 2
+
+typedef struct
+{
+    uint8_t button;       // INPUT_BUTTON_*
+    bool down;            // button pressed (falling level) or released (rising)
+    int64_t timestamp_us; // esp_timer time of the first edge of the change
+    int64_t queued_us;    // esp_timer time the change was debounced and queued
+} input_event_t;
+
+typedef struct
+{
+    int gpio_num[INPUT_BUTTON_COUNT];
+    uint32_t debounce_us; // how long a pin must settle before its level is trusted
+    QueueHandle_t queue;  // receives an input_event_t for every debounced change
+} input_config_t;
+
+typedef struct
+{
+    uint32_t presses;     // releases queued, one per press
+    uint32_t dropped;     // changes lost because config->queue was full
+    uint32_t raw_dropped; // edges or debounce expiries lost because the input task was behind
+} input_stats_t;
+
+// Configures the button pins and starts the input task, which debounces them
+// on level interrupts (debounce.h) that also wake the chip from light sleep.
+// Both edges of a press are reported, for gesture.h; the release (rising
+// level) is where the old polling tasks counted the press.
+void input_init(const input_config_t *config);
+
+void input_get_stats(input_stats_t *stats);
+
+#endif
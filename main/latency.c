@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include "latency.h"
+
+static const char *stage_names[LATENCY_STAGES] = {
+    [LATENCY_DEBOUNCE] = "debounce",
+    [LATENCY_QUEUE] = "queue",
+    [LATENCY_RULES] = "rules",
+    [LATENCY_PHOTON] = "photon",
+    [LATENCY_WAKE] = "wake",
+    [LATENCY_TICK] = "tick",
+};
+
+static latency_histogram_t histograms[LATENCY_STAGES];
+// latency_reset() only bumps reset_generation; each stage is cleared by its own
+// recorder, the one task writing it, so a reset never races a record
+static uint32_t reset_generation = 0;
+static uint32_t stage_generation[LATENCY_STAGES];
+
+#define LINEAR_BUCKETS 8
+#define SUB_BUCKETS 4 // per power of two
+
+static int bucket_of(uint32_t us)
+{
+    if (us < LINEAR_BUCKETS)
+    {
+        return us;
+    }
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - 2)) & (SUB_BUCKETS - 1);
+    int bucket = LINEAR_BUCKETS + (msb - 3) * SUB_BUCKETS + sub;
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+// Upper bound of a bucket, in us
+static uint32_t bucket_limit(int bucket)
+{
+    if (bucket < LINEAR_BUCKETS)
+    {
+        return bucket;
+    }
+    int msb = (bucket - LINEAR_BUCKETS) / SUB_BUCKETS + 3;
+    int sub = (bucket - LINEAR_BUCKETS) % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << (msb - 2)) - 1;
+}
+
+void latency_record(int stage, uint32_t us)
+{
+    latency_histogram_t *histogram = &histograms[stage];
+    uint32_t generation = __atomic_load_n(&reset_generation, __ATOMIC_ACQUIRE);
+    if (stage_generation[stage] != generation)
+    {
+        memset(histogram, 0, sizeof(*histogram));
+        __atomic_store_n(&stage_generation[stage], generation, __ATOMIC_RELEASE);
+    }
+    if (!histogram->count || us < histogram->min_us)
+    {
+        histogram->min_us = us;
+    }
+    if (us > histogram->max_us)
+    {
+        histogram->max_us = us;
+    }
+    histogram->total_us += us;
+    histogram->buckets[bucket_of(us)]++;
+    histogram->count++;
+}
+
+void latency_get(int stage, latency_histogram_t *histogram)
+{
+    // A stage not recorded since the last reset is still waiting to be cleared
+    if (__atomic_load_n(&stage_generation[stage], __ATOMIC_ACQUIRE) != __atomic_load_n(&reset_generation, __ATOMIC_ACQUIRE))
+    {
+        memset(histogram, 0, sizeof(*histogram));
+        return;
+    }
+    *histogram = histograms[stage];
+}
+
+void latency_reset(void)
+{
+    __atomic_fetch_add(&reset_generation, 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t percentile(const latency_histogram_t *histogram, uint32_t percent)
+{
+    uint32_t wanted = (histogram->count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+    {
+        seen += histogram->buckets[bucket];
+        if (seen >= wanted)
+        {
+            uint32_t limit = bucket_limit(bucket);
+            return bucket == LATENCY_BUCKETS - 1 || limit > histogram->max_us ? histogram->max_us : limit;
+        }
+    }
+    return histogram->max_us;
+}
+
+void latency_dump(void)
+{
+    for (int stage = 0; stage < LATENCY_STAGES; stage++)
+    {
+        latency_histogram_t histogram;
+        latency_get(stage, &histogram);
+        if (!histogram.count)
+        {
+            printf("%-8s no samples\n", stage_names[stage]);
+            continue;
+        }
+        printf("%-8s n=%lu min=%luus mean=%luus max=%luus p50<=%luus p90<=%luus p99<=%luus\n", stage_names[stage],
+               (unsigned long)histogram.count, (unsigned long)histogram.min_us,
+               (unsigned long)(histogram.total_us / histogram.count), (unsigned long)histogram.max_us,
+               (unsigned long)percentile(&histogram, 50), (unsigned long)percentile(&histogram, 90),
+               (unsigned long)percentile(&histogram, 99));
+        for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+        {
+            if (histogram.buckets[bucket])
+            {
+                printf("         <=%8luus %lu\n", (unsigned long)bucket_limit(bucket), (unsigned long)histogram.buckets[bucket]);
+            }
+        }
+    }
+}
+
+void latency_jitter(void)
+{
+    printf("%-8s %8s %8s %8s %8s %8s\n", "stage", "n", "p50<=us", "p99<=us", "max us", "jitter");
+    for (int stage = 0; stage < LATENCY_STAGES; stage++)
+    {
+        latency_histogram_t histogram;
+        latency_get(stage, &histogram);
+        if (!histogram.count)
+        {
+            printf("%-8s %8d\n", stage_names[stage], 0);
+            continue;
+        }
+        uint32_t p50 = percentile(&histogram, 50), p99 = percentile(&histogram, 99);
+        printf("%-8s %8lu %8lu %8lu %8lu %8lu\n", stage_names[stage], (unsigned long)histogram.count,
+               (unsigned long)p50, (unsigned long)p99, (unsigned long)histogram.max_us, (unsigned long)(p99 - p50));
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef _LATENCY_H__
+#define _LATENCY_H__
+
+#include <stdint.h>
+
+// Press-to-photon timing, stage by stage, in fixed log-linear histograms:
+// one bucket per microsecond below 8us, then four buckets per power of two
+// (at most 25% wide), the last one catching everything from ~1s up. Each
+// stage is recorded by a single task.
+
+#define LATENCY_DEBOUNCE 0 // first edge -> press queued by the input task
+#define LATENCY_QUEUE 1    // press queued -> taken by the game task
+#define LATENCY_RULES 2    // taken -> rules applied and frames queued
+#define LATENCY_PHOTON 3   // first edge -> rmt_tx_wait_all_done of its first frame
+#define LATENCY_WAKE 4     // debounce window closed -> input task running
+#define LATENCY_TICK 5     // render tick -> render task running
+#define LATENCY_STAGES 6
+
+#define LATENCY_BUCKETS 77
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[LATENCY_BUCKETS];
+} latency_histogram_t;
+
+void latency_record(int stage, uint32_t us);
+void latency_get(int stage, latency_histogram_t *histogram);
+// Safe while stages are being recorded: each one starts over with its next sample.
+void latency_reset(void);
+
+// Prints every stage: count, min/mean/max, p50/p90/p99 upper bounds and the buckets.
+void latency_dump(void);
+
+// One line per stage: p50, p99, max and the p50-p99 spread, the jitter
+void latency_jitter(void);
+
+#endif
@@ -4,21 +4,51 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <inttypes.h>
+#include <stdbool.h>
 #include "esp_check.h"
+#include "esp_cpu.h"
+#include "sysmem.h"
 #include "led_strip_encoder.h"
 
+#define LED_STRIP_RESET_US_DEFAULT 50
+#define LED_STRIP_SYMBOL_TICKS_MAX 0x7fff // 15-bit duration fields
+
 static const char *TAG = "led_encoder";
 
 typedef struct {
     rmt_encoder_t base;
-    rmt_encoder_t *bytes_encoder;
+    rmt_encoder_t *bytes_encoder; // NULL for the lookup table encoder
     rmt_encoder_t *copy_encoder;
+    rmt_symbol_word_t (*byte_symbols)[8]; // lookup table: the 8 symbols of each byte value, MSB first
+    bool owns_table; // false when byte_symbols belongs to another encoder
+    size_t byte_index; // next byte to expand in the current frame
     int state;
     rmt_symbol_word_t reset_code;
+    uint32_t frame_cycles;
+    uint32_t frame_calls;
+    led_strip_encoder_stats_t stats;
 } rmt_led_strip_encoder_t;
 
+static void led_strip_account(rmt_led_strip_encoder_t *led_encoder, uint32_t start_cycles, rmt_encode_state_t state)
+{
+    led_encoder->frame_cycles += esp_cpu_get_cycle_count() - start_cycles;
+    led_encoder->frame_calls++;
+    if (state & RMT_ENCODING_COMPLETE) {
+        led_encoder->stats.frames++;
+        led_encoder->stats.last_frame_cycles = led_encoder->frame_cycles;
+        led_encoder->stats.last_frame_calls = led_encoder->frame_calls;
+        if (led_encoder->frame_cycles > led_encoder->stats.max_frame_cycles) {
+            led_encoder->stats.max_frame_cycles = led_encoder->frame_cycles;
+        }
+        led_encoder->frame_cycles = 0;
+        led_encoder->frame_calls = 0;
+    }
+}
+
 static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
 {
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
     rmt_encoder_handle_t bytes_encoder = led_encoder->bytes_encoder;
     rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
@@ -49,6 +79,51 @@ static size_t rmt_encode_led_strip(rmt_encoder_t *encoder, rmt_channel_handle_t
         }
     }
 out:
+    led_strip_account(led_encoder, start_cycles, state);
+    *ret_state = state;
+    return encoded_symbols;
+}
+
+static size_t rmt_encode_led_strip_lut(rmt_encoder_t *encoder, rmt_channel_handle_t channel, const void *primary_data, size_t data_size, rmt_encode_state_t *ret_state)
+{
+    uint32_t start_cycles = esp_cpu_get_cycle_count();
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    rmt_encoder_handle_t copy_encoder = led_encoder->copy_encoder;
+    const uint8_t *bytes = primary_data;
+    rmt_encode_state_t session_state = RMT_ENCODING_RESET;
+    rmt_encode_state_t state = RMT_ENCODING_RESET;
+    size_t encoded_symbols = 0;
+    switch (led_encoder->state) {
+    case 0: // send RGB data, one table row per byte
+        while (led_encoder->byte_index < data_size) {
+            // the copy encoder remembers how much of a row it wrote when memory fills up
+            encoded_symbols += copy_encoder->encode(copy_encoder, channel, led_encoder->byte_symbols[bytes[led_encoder->byte_index]],
+                                                    sizeof(led_encoder->byte_symbols[0]), &session_state);
+            if (session_state & RMT_ENCODING_COMPLETE) {
+                led_encoder->byte_index++;
+            }
+            if (session_state & RMT_ENCODING_MEM_FULL) {
+                state |= RMT_ENCODING_MEM_FULL;
+                goto out; // yield if there's no free space for encoding artifacts
+            }
+        }
+        led_encoder->state = 1;
+    // fall-through
+    case 1: // send reset code
+        encoded_symbols += copy_encoder->encode(copy_encoder, channel, &led_encoder->reset_code,
+                                                sizeof(led_encoder->reset_code), &session_state);
+        if (session_state & RMT_ENCODING_COMPLETE) {
+            led_encoder->state = RMT_ENCODING_RESET; // back to the initial encoding session
+            led_encoder->byte_index = 0;
+            state |= RMT_ENCODING_COMPLETE;
+        }
+        if (session_state & RMT_ENCODING_MEM_FULL) {
+            state |= RMT_ENCODING_MEM_FULL;
+            goto out; // yield if there's no free space for encoding artifacts
+        }
+    }
+out:
+    led_strip_account(led_encoder, start_cycles, state);
     *ret_state = state;
     return encoded_symbols;
 }
@@ -56,18 +131,48 @@ out:
 static esp_err_t rmt_del_led_strip_encoder(rmt_encoder_t *encoder)
 {
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_del_encoder(led_encoder->bytes_encoder);
+    if (led_encoder->bytes_encoder) {
+        rmt_del_encoder(led_encoder->bytes_encoder);
+    }
     rmt_del_encoder(led_encoder->copy_encoder);
-    free(led_encoder);
+    if (led_encoder->owns_table) {
+        sysmem_free(led_encoder->byte_symbols);
+    }
+    sysmem_free(led_encoder);
     return ESP_OK;
 }
 
 static esp_err_t rmt_led_strip_encoder_reset(rmt_encoder_t *encoder)
 {
     rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
-    rmt_encoder_reset(led_encoder->bytes_encoder);
+    if (led_encoder->bytes_encoder) {
+        rmt_encoder_reset(led_encoder->bytes_encoder);
+    }
     rmt_encoder_reset(led_encoder->copy_encoder);
     led_encoder->state = RMT_ENCODING_RESET;
+    led_encoder->byte_index = 0;
+    led_encoder->frame_cycles = 0;
+    led_encoder->frame_calls = 0;
+    return ESP_OK;
+}
+
+static uint32_t led_strip_ns_to_ticks(uint32_t resolution, uint32_t ns)
+{
+    return (uint64_t)resolution * ns / 1000000000;
+}
+
+static esp_err_t led_strip_make_reset_code(const led_strip_encoder_config_t *config, rmt_symbol_word_t *reset_code)
+{
+    uint32_t reset_us = config->reset_us ? config->reset_us : LED_STRIP_RESET_US_DEFAULT;
+    uint32_t reset_ticks = (uint64_t)config->resolution * reset_us / 1000000 / 2;
+    ESP_RETURN_ON_FALSE(reset_ticks > 0 && reset_ticks <= LED_STRIP_SYMBOL_TICKS_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "reset code of %" PRIu32 "us does not fit one symbol", reset_us);
+    *reset_code = (rmt_symbol_word_t) {
+        .level0 = 0,
+        .duration0 = reset_ticks,
+        .level1 = 0,
+        .duration1 = reset_ticks,
+    };
     return ESP_OK;
 }
 
@@ -76,7 +181,7 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
     esp_err_t ret = ESP_OK;
     rmt_led_strip_encoder_t *led_encoder = NULL;
     ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
-    led_encoder = calloc(1, sizeof(rmt_led_strip_encoder_t));
+    led_encoder = sysmem_calloc(1, sizeof(rmt_led_strip_encoder_t));
     ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
     led_encoder->base.encode = rmt_encode_led_strip;
     led_encoder->base.del = rmt_del_led_strip_encoder;
@@ -101,13 +206,7 @@ esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rm
     rmt_copy_encoder_config_t copy_encoder_config = {};
     ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
 
-    uint32_t reset_ticks = config->resolution / 1000000 * 50 / 2; // reset code duration defaults to 50us
-    led_encoder->reset_code = (rmt_symbol_word_t) {
-        .level0 = 0,
-        .duration0 = reset_ticks,
-        .level1 = 0,
-        .duration1 = reset_ticks,
-    };
+    ESP_GOTO_ON_ERROR(led_strip_make_reset_code(config, &led_encoder->reset_code), err, TAG, "invalid reset length");
     *ret_encoder = &led_encoder->base;
     return ESP_OK;
 err:
@@ -118,7 +217,64 @@ err:
         if (led_encoder->copy_encoder) {
             rmt_del_encoder(led_encoder->copy_encoder);
         }
-        free(led_encoder);
+        sysmem_free(led_encoder);
+    }
+    return ret;
+}
+
+esp_err_t rmt_new_led_strip_lut_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder)
+{
+    esp_err_t ret = ESP_OK;
+    rmt_led_strip_encoder_t *led_encoder = NULL;
+    ESP_GOTO_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, err, TAG, "invalid argument");
+    led_encoder = sysmem_calloc(1, sizeof(rmt_led_strip_encoder_t));
+    ESP_GOTO_ON_FALSE(led_encoder, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip encoder");
+    led_encoder->base.encode = rmt_encode_led_strip_lut;
+    led_encoder->base.del = rmt_del_led_strip_encoder;
+    led_encoder->base.reset = rmt_led_strip_encoder_reset;
+    if (config->share_table) {
+        rmt_led_strip_encoder_t *owner = __containerof(config->share_table, rmt_led_strip_encoder_t, base);
+        ESP_GOTO_ON_FALSE(owner->byte_symbols, ESP_ERR_INVALID_ARG, err, TAG, "share_table is not a lookup table encoder");
+        led_encoder->byte_symbols = owner->byte_symbols;
+    } else {
+        led_encoder->byte_symbols = sysmem_calloc(256, sizeof(led_encoder->byte_symbols[0]));
+        ESP_GOTO_ON_FALSE(led_encoder->byte_symbols, ESP_ERR_NO_MEM, err, TAG, "no mem for led strip symbol table");
+        led_encoder->owns_table = true;
+        // WS2812 timings, same as rmt_new_led_strip_encoder
+        uint32_t short_ticks = led_strip_ns_to_ticks(config->resolution, 300); // T0H, T1L
+        uint32_t long_ticks = led_strip_ns_to_ticks(config->resolution, 900);  // T0L, T1H
+        ESP_GOTO_ON_FALSE(short_ticks > 0 && long_ticks <= LED_STRIP_SYMBOL_TICKS_MAX, ESP_ERR_INVALID_ARG, err, TAG, "unsupported resolution");
+        const rmt_symbol_word_t bit0 = {.level0 = 1, .duration0 = short_ticks, .level1 = 0, .duration1 = long_ticks};
+        const rmt_symbol_word_t bit1 = {.level0 = 1, .duration0 = long_ticks, .level1 = 0, .duration1 = short_ticks};
+        for (int byte = 0; byte < 256; byte++) {
+            for (int bit = 0; bit < 8; bit++) {
+                // WS2812 transfer bit order: MSB first
+                led_encoder->byte_symbols[byte][bit] = (byte & (0x80 >> bit)) ? bit1 : bit0;
+            }
+        }
+    }
+    rmt_copy_encoder_config_t copy_encoder_config = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&copy_encoder_config, &led_encoder->copy_encoder), err, TAG, "create copy encoder failed");
+    ESP_GOTO_ON_ERROR(led_strip_make_reset_code(config, &led_encoder->reset_code), err, TAG, "invalid reset length");
+    *ret_encoder = &led_encoder->base;
+    return ESP_OK;
+err:
+    if (led_encoder) {
+        if (led_encoder->copy_encoder) {
+            rmt_del_encoder(led_encoder->copy_encoder);
+        }
+        if (led_encoder->owns_table) {
+            sysmem_free(led_encoder->byte_symbols);
+        }
+        sysmem_free(led_encoder);
     }
     return ret;
 }
+
+esp_err_t rmt_led_strip_encoder_get_stats(rmt_encoder_handle_t encoder, led_strip_encoder_stats_t *ret_stats)
+{
+    ESP_RETURN_ON_FALSE(encoder && ret_stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_led_strip_encoder_t *led_encoder = __containerof(encoder, rmt_led_strip_encoder_t, base);
+    *ret_stats = led_encoder->stats;
+    return ESP_OK;
+}
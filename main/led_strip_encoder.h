@@ -17,11 +17,30 @@ extern "C" {
  */
 typedef struct {
     uint32_t resolution; /*!< Encoder resolution, in Hz */
+    uint32_t reset_us;   /*!< Length of the reset (latch) code, in us; 0 for the 50us default */
+    rmt_encoder_handle_t share_table; /*!< Lookup table encoder whose symbol table to reuse, NULL to build one; lookup table encoders only */
 } led_strip_encoder_config_t;
 
+/**
+ * @brief Encoding time of the frames sent through a led strip encoder
+ *
+ * A frame is encoded in several calls, one per refill of the channel's RMT memory;
+ * the time is the sum of those calls, most of them made from the RMT ISR.
+ */
+typedef struct {
+    uint32_t frames;            /*!< Frames fully encoded */
+    uint32_t last_frame_cycles; /*!< CPU cycles spent encoding the last frame */
+    uint32_t max_frame_cycles;  /*!< Worst frame so far, in CPU cycles */
+    uint32_t last_frame_calls;  /*!< Encode calls (memory refills) for the last frame */
+} led_strip_encoder_stats_t;
+
 /**
  * @brief Create RMT encoder for encoding LED strip pixels into RMT symbols
  *
+ * The encoder keeps the state of the transaction it is encoding, so every channel needs its own.
+ *
+ * The encoder is allocated with sysmem_calloc(), the RMT bytes and copy encoders inside it by ESP-IDF.
+ *
  * @param[in] config Encoder configuration
  * @param[out] ret_encoder Returned encoder handle
  * @return
@@ -31,6 +50,34 @@ typedef struct {
  */
 esp_err_t rmt_new_led_strip_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
 
+/**
+ * @brief Create RMT encoder for LED strip pixels that expands each byte through a lookup table
+ *
+ * The 8 RMT symbols of every possible byte are computed once at creation (8KB, see sysmem_calloc),
+ * so encoding a byte is a copy of 8 words into RMT memory instead of a loop over its bits.
+ * The table is only read while encoding, so encoders of other channels can share it (share_table);
+ * the encoder itself keeps the state of one transaction and serves one channel.
+ *
+ * @param[in] config Encoder configuration
+ * @param[out] ret_encoder Returned encoder handle
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_ERR_NO_MEM out of memory when creating led strip encoder
+ *      - ESP_OK if creating encoder successfully
+ */
+esp_err_t rmt_new_led_strip_lut_encoder(const led_strip_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
+/**
+ * @brief Get the encoding time of an encoder made by one of the functions above
+ *
+ * @param[in] encoder Encoder handle
+ * @param[out] ret_stats Returned statistics
+ * @return
+ *      - ESP_ERR_INVALID_ARG for any invalid arguments
+ *      - ESP_OK on success
+ */
+esp_err_t rmt_led_strip_encoder_get_stats(rmt_encoder_handle_t encoder, led_strip_encoder_stats_t *ret_stats);
+
 #ifdef __cplusplus
 }
 #endif
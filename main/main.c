@@ -1,436 +1,241 @@
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "driver/rmt_tx.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
 #include "led_strip_encoder.h"
 #include "display.h"
+#include "framebuffer.h"
+#include "input.h"
+#include "buzzer.h"
+#include "rules.h"
+#include "scoreboard.h"
+#include "render.h"
+#include "latency.h"
+#include "console.h"
+#include "eventlog.h"
+#include "persist.h"
+#include "history.h"
+#include "gesture.h"
+#include "sysmem.h"
+#include "sched.h"
+#include "power.h"
 
 #define LED_TEAM_1_GPIO_NUM 13
 #define LED_TEAM_2_GPIO_NUM 12
 #define BUZZER_GPIO_NUM 26
+#define BUZZER_USE_LEDC false // true for a passive buzzer driven with LEDC tones
 #define BTN_1_TEAM_GPIO_NUM 14
 #define BTN_2_TEAM_GPIO_NUM 27
 
 #define RMT_LED_STRIP_RESOLUTION_HZ 10000000 // 10MHz resolution, 1 tick = 0.1us
-#define GPIO_OUTPUT_PIN_SEL ((1ULL << BUZZER_GPIO_NUM))
-#define GPIO_INPUT_PIN_SEL ((1ULL << BTN_1_TEAM_GPIO_NUM) | (1ULL << BTN_2_TEAM_GPIO_NUM))
-
-#define LED_NUMBERS 15
-#define CHASE_SPEED_MS 100
-#define DEBOUNCE_TIME_MS 100
-
-#define LED_SET_GAME 14
+#define LED_STRIP_USE_LUT_ENCODER true        // false for the bytes encoder from the Espressif example
+#define LED_STRIP_RESET_US 50
+#define RENDER_FPS 60
+#define LED_BRIGHTNESS 160        // 0-255, before gamma
+#define LED_CURRENT_LIMIT_MA 1200 // both strips, keep under what the supply can give
+
+#define RULES_FORMAT_DEFAULT RULES_FORMAT_CLASSIC // until a long chord at 0-0 picks the next one
+#define DEBOUNCE_TIME_MS 30      // pin must be stable this long after its first edge
+#define GESTURE_LONG_MS 800      // held this long: undo (one button) or restart (both)
+#define GESTURE_CHORD_MS 200     // both buttons down within this: a chord
+#define GESTURE_DOUBLE_MS 300    // second press within this: a double press...
+#define GESTURE_DOUBLE_BUTTONS 0 // ...on these buttons only, each one delays its single presses by GESTURE_DOUBLE_MS
+#define BOOT_FIRST_FRAME_MS 300 // since reset, logged as a warning when the score shows later
+#define GAME_QUEUE_DEPTH 16      // button edges waiting for the game task
+#define GAME_TASK_STACK 4096
 
 static const char *TAG = "PETECA";
-static SemaphoreHandle_t semaphore_btn_action = NULL;
+static QueueHandle_t game_queue = NULL;
 static rmt_channel_handle_t led_team_1 = NULL;
 static rmt_channel_handle_t led_team_2 = NULL;
-static rmt_encoder_handle_t led_encoder = NULL;
-static uint8_t led_strip_pixels[2][LED_NUMBERS * 3] = {0};
-static uint8_t scoreboard_team_1 = 0, scoreboard_team_2 = 0;
-static bool set_final_blue_team = false, set_final_red_team = false;
-static bool set_blue_team = false, set_red_team = false;
-
-static void led(rmt_channel_handle_t *team, int position, rgb color)
+static rmt_encoder_handle_t led_encoders[STRIP_COUNT] = {NULL};
+static uint8_t format = RULES_FORMAT_DEFAULT;
+static const rules_config_t *rules = &rules_formats[RULES_FORMAT_DEFAULT];
+static rules_state_t match;
+static history_t history;
+static gesture_classifier_t gestures;
+
+// Starts from a restored match when there is one, otherwise from zero
+static void start_game(const rules_state_t *restored)
 {
-    int _team = *team == led_team_1 ? 0 : 1;
-    led_strip_pixels[_team][position * 3 + 0] = color.green;
-    led_strip_pixels[_team][position * 3 + 1] = color.red;
-    led_strip_pixels[_team][position * 3 + 2] = color.blue;
-    rmt_transmit_config_t tx_config = {
-        .loop_count = 0, // no transfer loop
-    };
-    ESP_ERROR_CHECK(rmt_transmit(*team, led_encoder, led_strip_pixels[_team], sizeof(led_strip_pixels[_team]), &tx_config));
-    ESP_ERROR_CHECK(rmt_tx_wait_all_done(*team, portMAX_DELAY));
+    match = restored ? *restored : rules_initial();
+    history_start(&history, &match);
+    scoreboard_show(rules, &match, 0, 0);
+
+    buzzer_play(&BUZZER_START);
 }
 
-static rgb check_color(uint8_t flag, rgb color)
+// Puts the match back to where it was before the last point
+static void undo_point(void)
 {
-    if (flag < 0)
+    if (!history_undo(&history, &match))
     {
-        return NO_COLOR;
+        return;
     }
-    return color;
+    scoreboard_show(rules, &match, 0, 0);
+    buzzer_play(&BUZZER_UNDO);
+    persist_request(&match, format);
+    eventlog_write(EVENTLOG_UNDO, rules_pack(&match), history_undoable(&history));
 }
 
-static void display_reset(rmt_channel_handle_t *team)
+// Scores a point for the side whose button was pressed and hands the result to render and buzzer
+static void score_point(const gesture_t *gesture)
 {
-    number _num = get_number(8);
-    led(team, _num.top.led_1, NO_COLOR);
-    led(team, _num.top.led_2, NO_COLOR);
-    led(team, _num.top_left.led_1, NO_COLOR);
-    led(team, _num.top_left.led_2, NO_COLOR);
-    led(team, _num.top_right.led_1, NO_COLOR);
-    led(team, _num.top_right.led_2, NO_COLOR);
-
-    led(team, _num.mid.led_1, NO_COLOR);
-    led(team, _num.mid.led_2, NO_COLOR);
+    int64_t taken_us = esp_timer_get_time();
+    uint8_t side = gesture->button == INPUT_BUTTON_1 ? RULES_EVENT_SIDE_1 : RULES_EVENT_SIDE_2;
+    rules_result_t result = rules_apply(rules, match, side);
+    match = result.state;
+    history_push(&history, &match, side);
+
+    render_stamp(gesture->timestamp_us);
+    scoreboard_show(rules, &match, result.effects, result.team);
+    if (result.effects & RULES_EFFECT_END)
+    {
+        // GG
+        buzzer_play(&BUZZER_END);
+    }
+    else
+    {
+        if (result.effects & RULES_EFFECT_SWAP)
+        {
+            buzzer_play(&BUZZER_INVERT);
+        }
+        buzzer_play(&BUZZER_POINT);
+    }
+    persist_request(&match, format);
+    uint32_t rules_us = esp_timer_get_time() - taken_us;
+    latency_record(LATENCY_RULES, rules_us);
 
-    led(team, _num.bot.led_1, NO_COLOR);
-    led(team, _num.bot.led_2, NO_COLOR);
-    led(team, _num.bot_left.led_1, NO_COLOR);
-    led(team, _num.bot_left.led_2, NO_COLOR);
-    led(team, _num.bot_right.led_1, NO_COLOR);
-    led(team, _num.bot_right.led_2, NO_COLOR);
+    // Formatted later by the eventlog task, off the scoring path
+    eventlog_write(EVENTLOG_SCORE, rules_pack(&match),
+                   result.effects | result.team << 8 | (rules_us < 0xffff ? rules_us : 0xffff) << 16);
 }
 
-static void display_number(rmt_channel_handle_t *team, uint8_t num, rgb color)
+// Next match format, shown by its number; the undo history of the old one is dropped
+static void next_format(void)
 {
-    display_reset(team);
-    number _num = get_number(num);
-    led(team, _num.top.led_1, check_color(_num.top.led_1, color));
-    led(team, _num.top.led_2, check_color(_num.top.led_2, color));
-    led(team, _num.top_left.led_1, check_color(_num.top_left.led_1, color));
-    led(team, _num.top_left.led_2, check_color(_num.top_left.led_2, color));
-    led(team, _num.top_right.led_1, check_color(_num.top_right.led_1, color));
-    led(team, _num.top_right.led_2, check_color(_num.top_right.led_2, color));
-
-    led(team, _num.mid.led_1, check_color(_num.mid.led_1, color));
-    led(team, _num.mid.led_2, check_color(_num.mid.led_2, color));
-
-    led(team, _num.bot.led_1, check_color(_num.bot.led_1, color));
-    led(team, _num.bot.led_2, check_color(_num.bot.led_2, color));
-    led(team, _num.bot_left.led_1, check_color(_num.bot_left.led_1, color));
-    led(team, _num.bot_left.led_2, check_color(_num.bot_left.led_2, color));
-    led(team, _num.bot_right.led_1, check_color(_num.bot_right.led_1, color));
-    led(team, _num.bot_right.led_2, check_color(_num.bot_right.led_2, color));
+    format = (format + 1) % RULES_FORMAT_COUNT;
+    rules = &rules_formats[format];
+    // start_game() then records a START entry, which undo never crosses either
+    history_reset(&history);
+    scoreboard_announce(format + 1);
+    ESP_LOGI(TAG, "Format %u: %s", format + 1, rules->name);
 }
 
-static void start_game()
+static void on_gesture(const gesture_t *gesture)
 {
-    scoreboard_team_1 = 0;
-    scoreboard_team_2 = 0;
-    set_blue_team = false;
-    set_red_team = false;
-    set_final_blue_team = false;
-    set_final_red_team = false;
-
-    led(&led_team_1, LED_SET_GAME, NO_COLOR);
-    led(&led_team_2, LED_SET_GAME, NO_COLOR);
-    // display_reset(&led_team_1);
-    // display_reset(&led_team_2);
-    display_number(&led_team_1, scoreboard_team_1, COLOR_BLUE);
-    display_number(&led_team_2, scoreboard_team_2, COLOR_RED);
-
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    xSemaphoreGive(semaphore_btn_action);
+    if (gesture->kind != GESTURE_PRESS)
+    {
+        eventlog_write(EVENTLOG_GESTURE, gesture->kind | gesture->button << 8,
+                       (gesture->timestamp_us - gesture->started_us) / 1000);
+    }
+    switch (gesture->kind)
+    {
+    case GESTURE_PRESS:
+        score_point(gesture);
+        break;
+    case GESTURE_LONG:
+    case GESTURE_CHORD:
+        undo_point();
+        break;
+    case GESTURE_CHORD_LONG:
+    {
+        // Restarts; at the start of a match there is nothing to restart, so it changes the format
+        rules_state_t initial = rules_initial();
+        if (rules_pack(&match) == rules_pack(&initial))
+        {
+            next_format();
+        }
+        start_game(NULL);
+        persist_request(&match, format);
+        break;
+    }
+    default:
+        // GESTURE_DOUBLE: nothing bound to it yet, see GESTURE_DOUBLE_BUTTONS
+        break;
+    }
 }
 
-static void end_game()
+// Last match saved by persist_task, if the board rebooted mid-match
+static bool restore_match(rules_state_t *state, uint8_t *format)
 {
-    printf("ACABOUUUUUUUU!!!\n\n");
-    display_reset(&led_team_1);
-    display_reset(&led_team_2);
-    scoreboard_team_1 = 0;
-    scoreboard_team_2 = 0;
-    set_blue_team = false;
-    set_red_team = false;
-    set_final_blue_team = false;
-    set_final_red_team = false;
-
-    led(&led_team_1, LED_SET_GAME, NO_COLOR);
-    led(&led_team_2, LED_SET_GAME, NO_COLOR);
-
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(1000 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, 8, COLOR_PURPLE);
-    display_number(&led_team_2, 8, COLOR_PURPLE);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(100 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+    {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        err = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK(err);
 
-    vTaskDelay(5000 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, scoreboard_team_1, COLOR_BLUE);
-    display_number(&led_team_2, scoreboard_team_2, COLOR_RED);
-    xSemaphoreGive(semaphore_btn_action);
+    persist_backend_t backend;
+    ESP_ERROR_CHECK(persist_nvs_backend(&backend));
+    persist_init(&backend);
+    if (!persist_load(state, format))
+    {
+        return false;
+    }
+    ESP_LOGI(TAG, "Restored %u-%u sets %u-%u, format %s", state->score[RULES_TEAM_BLUE], state->score[RULES_TEAM_RED],
+             state->sets[RULES_TEAM_BLUE], state->sets[RULES_TEAM_RED], rules_formats[*format].name);
+    return true;
 }
 
-static void invert_game()
+// Draws the score straight to the strips, in one commit, before the render task exists
+static void first_frame(const rules_state_t *restored)
 {
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    display_reset(&led_team_1);
-    display_reset(&led_team_2);
-    vTaskDelay(200 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    display_reset(&led_team_1);
-    display_reset(&led_team_2);
-    vTaskDelay(200 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    display_reset(&led_team_1);
-    display_reset(&led_team_2);
-    vTaskDelay(200 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    display_reset(&led_team_1);
-    display_reset(&led_team_2);
-    vTaskDelay(200 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
-    display_reset(&led_team_1);
-    display_reset(&led_team_2);
-    vTaskDelay(200 / portTICK_PERIOD_MS);
-    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-    gpio_set_level(BUZZER_GPIO_NUM, 1);
-    vTaskDelay(500 / portTICK_PERIOD_MS);
-    gpio_set_level(BUZZER_GPIO_NUM, 0);
+    rules_state_t state = restored ? *restored : rules_initial();
+    scoreboard_draw(rules, &state);
+    framebuffer_commit_all();
+    uint32_t boot_ms = esp_timer_get_time() / 1000;
+    if (boot_ms > BOOT_FIRST_FRAME_MS)
+    {
+        ESP_LOGW(TAG, "First frame at %lums, over the %ums budget", (unsigned long)boot_ms, BOOT_FIRST_FRAME_MS);
+    }
+    else
+    {
+        ESP_LOGI(TAG, "First frame at %lums", (unsigned long)boot_ms);
+    }
 }
 
-static void debounce_btn_team_task(int BTN_GPIO)
+// Owns the match: button edges become gestures, applied one at a time in the order they were made
+static void game_task(void *arg)
 {
-    int level = gpio_get_level(BTN_GPIO);
-    int last_level = level;
-
+    input_event_t event;
+    gesture_t completed[GESTURE_MAX_OUT];
     while (1)
     {
-
-        vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_TIME_MS));
-
-        level = gpio_get_level(BTN_GPIO);
-
-        if (level != last_level)
+        // Wakes up for a single press held back by a double press window, if any
+        TickType_t wait = portMAX_DELAY;
+        int64_t deadline = gesture_deadline(&gestures);
+        if (deadline != INT64_MAX)
         {
-            // O estado do pino mudou, aguarde para confirmar a mudança
-            vTaskDelay(pdMS_TO_TICKS(DEBOUNCE_TIME_MS));
-            level = gpio_get_level(BTN_GPIO);
-
-            if (level != last_level)
-            {
-                if (level)
-                {
-                    if (xSemaphoreTake(semaphore_btn_action, pdMS_TO_TICKS(5000)) == pdTRUE)
-                    {
-                        // printf("PONTO (%d) GPIO: %d\n", level, BTN_GPIO);
-                        // BTN 1
-                        if (BTN_GPIO == BTN_1_TEAM_GPIO_NUM)
-                        {
-                            if (set_blue_team || set_red_team)
-                            {
-                                if (set_final_red_team)
-                                {
-                                    if (set_final_blue_team && scoreboard_team_1 == 1)
-                                    {
-                                        // vai a 2
-                                        scoreboard_team_1 = 0;
-                                        scoreboard_team_2 = 0;
-                                        display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                        display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                    }
-                                    else
-                                    {
-                                        scoreboard_team_2++;
-                                        display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                        if (set_final_blue_team && scoreboard_team_1 == 1)
-                                        {
-                                            // vai a 2
-                                            scoreboard_team_1 = 0;
-                                            scoreboard_team_2 = 0;
-                                            display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                            display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                        }
-                                        else if (!set_final_blue_team || (scoreboard_team_1 == 0 && scoreboard_team_2 == 2))
-                                        {
-                                            // GG
-                                            last_level = level;
-                                            end_game();
-                                            continue;
-                                        }
-                                    }
-                                }
-                                else
-                                {
-                                    //// PASSO 3 RED
-                                    if (scoreboard_team_2 == 9)
-                                    {
-                                        scoreboard_team_2 = 0;
-
-                                        if (set_red_team)
-                                        {
-                                            set_final_red_team = true;
-                                            led(&led_team_1, LED_SET_GAME, COLOR_WHITE);
-                                            if (set_final_blue_team)
-                                            {
-                                                scoreboard_team_1 = 0;
-                                                scoreboard_team_2 = 0;
-                                                display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                                display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                            }
-                                        }
-                                        else
-                                        {
-                                            set_red_team = true;
-                                            led(&led_team_1, LED_SET_GAME, COLOR_GREEN);
-                                        }
-                                        display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                    }
-                                    else
-                                    {
-                                        scoreboard_team_2++;
-                                        display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                // PONTO NORMAL
-                                if (scoreboard_team_1 == 9)
-                                {
-                                    //// PASSO 2 FIZ 9 PONTOS INVERTIR
-                                    scoreboard_team_1 = 0;
-                                    set_blue_team = true;
-                                    led(&led_team_2, LED_SET_GAME, COLOR_GREEN);
-                                    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                    invert_game();
-                                }
-                                else
-                                {
-                                    // PASSO 1
-                                    scoreboard_team_1++;
-                                    display_number(&led_team_1, scoreboard_team_1, COLOR_BLUE);
-                                }
-                            }
-                        }
-
-                        // BTN 2
-                        else
-                        {
-                            if (set_blue_team || set_red_team)
-                            {
-                                if (set_final_blue_team)
-                                {
-                                    if (set_final_red_team && scoreboard_team_2 == 1)
-                                    {
-                                        scoreboard_team_1 = 0;
-                                        scoreboard_team_2 = 0;
-                                        display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                        display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                    }
-                                    else
-                                    {
-                                        scoreboard_team_1++;
-                                        display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                        if (set_final_red_team && scoreboard_team_2 == 1)
-                                        {
-                                            scoreboard_team_1 = 0;
-                                            scoreboard_team_2 = 0;
-                                            display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                            display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                        }
-                                        else if (!set_final_red_team || (scoreboard_team_2 == 0 && scoreboard_team_1 == 2))
-                                        {
-                                            // GG
-                                            last_level = level;
-                                            end_game();
-                                            continue;
-                                        }
-                                    }
-                                }
-                                else
-                                {
-                                    //// PASSO 3 AZUL
-                                    if (scoreboard_team_1 == 9)
-                                    {
-                                        scoreboard_team_1 = 0;
-
-                                        if (set_blue_team)
-                                        {
-                                            set_final_blue_team = true;
-                                            led(&led_team_2, LED_SET_GAME, COLOR_WHITE);
-                                            if (set_final_red_team)
-                                            {
-                                                scoreboard_team_1 = 0;
-                                                scoreboard_team_2 = 0;
-                                                display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                                display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                            }
-                                        }
-                                        else
-                                        {
-                                            set_blue_team = true;
-                                            led(&led_team_2, LED_SET_GAME, COLOR_GREEN);
-                                        }
-                                        display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                    }
-                                    else
-                                    {
-                                        scoreboard_team_1++;
-                                        display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                    }
-                                }
-                            }
-                            else
-                            {
-                                // PONTO NORMAL
-                                if (scoreboard_team_2 == 9)
-                                {
-                                    //// PASSO 2 FIZ 9 PONTOS INVERTIR
-                                    scoreboard_team_2 = 0;
-                                    set_red_team = true;
-                                    led(&led_team_1, LED_SET_GAME, COLOR_GREEN);
-                                    display_number(&led_team_1, scoreboard_team_2, COLOR_RED);
-                                    display_number(&led_team_2, scoreboard_team_1, COLOR_BLUE);
-                                    invert_game();
-                                }
-                                else
-                                {
-                                    // PASSO 1
-                                    scoreboard_team_2++;
-                                    display_number(&led_team_2, scoreboard_team_2, COLOR_RED);
-                                }
-                            }
-                        }
-
-                        printf("SCORE 1(%d) - SCORE 2(%d) | set_blue_team(%s) - set_red_team(%s) | set_final_blue_team(%s) - set_final_red_team(%s)\n\n",
-                               scoreboard_team_1, scoreboard_team_2,
-                               (set_blue_team ? "true" : "false"),
-                               (set_red_team ? "true" : "false"),
-                               (set_final_blue_team ? "true" : "false"),
-                               (set_final_red_team ? "true" : "false"));
-
-                        gpio_set_level(BUZZER_GPIO_NUM, 1);
-                        vTaskDelay(150 / portTICK_PERIOD_MS);
-                        gpio_set_level(BUZZER_GPIO_NUM, 0);
-                        vTaskDelay(30 / portTICK_PERIOD_MS);
-                        gpio_set_level(BUZZER_GPIO_NUM, 1);
-                        vTaskDelay(600 / portTICK_PERIOD_MS);
-                        gpio_set_level(BUZZER_GPIO_NUM, 0);
-
-                        vTaskDelay(2000 / portTICK_PERIOD_MS);
-
-                        xSemaphoreGive(semaphore_btn_action);
-                    }
-                }
-            }
+            int64_t left_us = deadline - esp_timer_get_time();
+            wait = left_us > 0 ? pdMS_TO_TICKS(left_us / 1000) + 1 : 0;
+        }
+        bool received = xQueueReceive(game_queue, &event, wait) == pdTRUE;
 
-            last_level = level;
+        int count = gesture_expire(&gestures, received ? event.timestamp_us : esp_timer_get_time(), completed);
+        for (int i = 0; i < count; i++)
+        {
+            on_gesture(&completed[i]);
+        }
+        if (!received)
+        {
+            continue;
+        }
+        if (!event.down)
+        {
+            latency_record(LATENCY_DEBOUNCE, event.queued_us - event.timestamp_us);
+            latency_record(LATENCY_QUEUE, esp_timer_get_time() - event.queued_us);
+        }
+        count = gesture_edge(&gestures, event.button, event.down, event.timestamp_us, completed);
+        for (int i = 0; i < count; i++)
+        {
+            on_gesture(&completed[i]);
         }
     }
 }
@@ -439,25 +244,29 @@ void app_main(void)
 {
 
     ESP_LOGI(TAG, "Start!!!");
-    semaphore_btn_action = xSemaphoreCreateBinary();
-    xSemaphoreGive(semaphore_btn_action);
-
-    gpio_config_t buzzer_config;
-    buzzer_config.intr_type = GPIO_INTR_DISABLE;
-    buzzer_config.mode = GPIO_MODE_OUTPUT;
-    buzzer_config.pin_bit_mask = GPIO_OUTPUT_PIN_SEL;
-    buzzer_config.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    buzzer_config.pull_up_en = GPIO_PULLUP_DISABLE;
-    gpio_config(&buzzer_config);
+    sysmem_init();
+    eventlog_init();
+    sysmem_phase("eventlog");
+
+    // Buttons first: presses made while the rest boots wait in the game queue
+    game_queue = sysmem_queue(GAME_QUEUE_DEPTH, sizeof(input_event_t));
+    input_config_t input_config = {
+        .gpio_num = {
+            [INPUT_BUTTON_1] = BTN_1_TEAM_GPIO_NUM,
+            [INPUT_BUTTON_2] = BTN_2_TEAM_GPIO_NUM,
+        },
+        .debounce_us = DEBOUNCE_TIME_MS * 1000,
+        .queue = game_queue,
+    };
+    input_init(&input_config);
+    sysmem_phase("input");
 
-    gpio_config_t btn_teams_config;
-    btn_teams_config.intr_type = GPIO_INTR_DISABLE;
-    btn_teams_config.mode = GPIO_MODE_INPUT;
-    btn_teams_config.pin_bit_mask = GPIO_INPUT_PIN_SEL;
-    btn_teams_config.pull_down_en = GPIO_PULLDOWN_DISABLE;
-    btn_teams_config.pull_up_en = GPIO_PULLUP_ENABLE;
-    gpio_config(&btn_teams_config);
+    rules_state_t restored;
+    bool has_restored = restore_match(&restored, &format);
+    rules = &rules_formats[format];
+    sysmem_phase("nvs");
 
+    // The RMT interrupts go to the core creating the channels: app_main runs on SCHED_CORE_OUTPUT
     rmt_tx_channel_config_t tx_chan_blue_config = {
         .clk_src = RMT_CLK_SRC_DEFAULT, // select source clock
         .gpio_num = LED_TEAM_1_GPIO_NUM,
@@ -476,33 +285,60 @@ void app_main(void)
     };
     ESP_ERROR_CHECK(rmt_new_tx_channel(&tx_chan_red_config, &led_team_2));
 
-    ESP_LOGI(TAG, "Install led strip encoder");
-    led_strip_encoder_config_t encoder_config = {
-        .resolution = RMT_LED_STRIP_RESOLUTION_HZ,
-    };
-    ESP_ERROR_CHECK(rmt_new_led_strip_encoder(&encoder_config, &led_encoder));
+    sysmem_phase("rmt");
+
+    ESP_LOGI(TAG, "Install led strip encoders");
+    // The strips transmit at the same time and an encoder holds one transaction, so one per strip
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        led_strip_encoder_config_t encoder_config = {
+            .resolution = RMT_LED_STRIP_RESOLUTION_HZ,
+            .reset_us = LED_STRIP_RESET_US,
+            .share_table = led_encoders[0], // the lookup table is built once
+        };
+        if (LED_STRIP_USE_LUT_ENCODER)
+        {
+            ESP_ERROR_CHECK(rmt_new_led_strip_lut_encoder(&encoder_config, &led_encoders[strip]));
+        }
+        else
+        {
+            ESP_ERROR_CHECK(rmt_new_led_strip_encoder(&encoder_config, &led_encoders[strip]));
+        }
+    }
+    sysmem_phase("encoder");
 
     ESP_LOGI(TAG, "Enable RMT TX channel");
     ESP_ERROR_CHECK(rmt_enable(led_team_1));
     ESP_ERROR_CHECK(rmt_enable(led_team_2));
 
-    start_game();
-
-    xTaskCreate(debounce_btn_team_task, "debounce_t_1", 2048, BTN_1_TEAM_GPIO_NUM, 10, NULL);
-    xTaskCreate(debounce_btn_team_task, "debounce_t_2", 2048, BTN_2_TEAM_GPIO_NUM, 10, NULL);
-
-    // while (1)
-    // {
-
-    //     for (uint8_t i = 0, j = 9; i < 10 && j >= 0; i++, j--)
-    //     {
-    //         // printf("i=%d - j=%d\n", i, j);
-    //         display_number(&led_team_1, i, COLOR_BLUE);
-    //         display_number(&led_team_2, j, COLOR_RED);
-    //         vTaskDelay(pdMS_TO_TICKS(500));
-    //         display_reset(&led_team_1);
-    //         display_reset(&led_team_2);
-    //         vTaskDelay(pdMS_TO_TICKS(100));
-    //     }
-    // }
+    rmt_channel_handle_t strips[STRIP_COUNT] = {led_team_1, led_team_2};
+    const gpio_num_t strip_pins[STRIP_COUNT] = {LED_TEAM_1_GPIO_NUM, LED_TEAM_2_GPIO_NUM};
+    framebuffer_init(strips, led_encoders, strip_pins);
+    framebuffer_set_brightness(STRIP_TEAM_1, LED_BRIGHTNESS);
+    framebuffer_set_brightness(STRIP_TEAM_2, LED_BRIGHTNESS);
+    framebuffer_set_current_limit(LED_CURRENT_LIMIT_MA);
+    first_frame(has_restored ? &restored : NULL);
+    sysmem_phase("first frame");
+
+    render_init(RENDER_FPS);
+    buzzer_init(BUZZER_GPIO_NUM, BUZZER_USE_LEDC);
+    gesture_config_t gesture_config = {
+        .long_us = GESTURE_LONG_MS * 1000,
+        .chord_us = GESTURE_CHORD_MS * 1000,
+        .double_us = GESTURE_DOUBLE_MS * 1000,
+        .double_buttons = GESTURE_DOUBLE_BUTTONS,
+    };
+    gesture_init(&gestures, &gesture_config);
+    start_game(has_restored ? &restored : NULL);
+    persist_start();
+    sysmem_task(game_task, "game", GAME_TASK_STACK, NULL, SCHED_GAME_PRIORITY, SCHED_CORE(SCHED_CORE_SCORING));
+    sysmem_phase("game");
+
+    console_init(led_encoders, &history);
+    sysmem_phase("console");
+
+    // Runs the debounce and render tick callbacks
+    sysmem_register_task(xTaskGetHandle("esp_timer"), CONFIG_ESP_TIMER_TASK_STACK_SIZE);
+    sysmem_report();
+    power_init();
 }
@@ -0,0 +1,94 @@
+#include "persist.h"
+
+#define PERSIST_MAGIC 0x5a
+
+static persist_backend_t persist_backend;
+static uint32_t last_seq = 0;
+static int last_slot = PERSIST_SLOTS - 1;
+
+// CRC-8 (poly 0x07) over the 48 payload bits
+static uint8_t crc8(uint64_t payload)
+{
+    uint8_t crc = 0;
+    for (int byte = 0; byte < 6; byte++)
+    {
+        crc ^= (payload >> (byte * 8)) & 0xff;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// seq in bits 16-47, format in 12-15, state in 0-11, magic and CRC in the top 16
+uint64_t persist_encode(uint32_t seq, const rules_state_t *state, uint8_t format)
+{
+    uint64_t payload = (uint64_t)seq << 16 | format << 12 | rules_pack(state);
+    return (uint64_t)PERSIST_MAGIC << 56 | (uint64_t)crc8(payload) << 48 | payload;
+}
+
+bool persist_decode(uint64_t record, uint32_t *seq, rules_state_t *state, uint8_t *format)
+{
+    uint64_t payload = record & 0xffffffffffffULL;
+    uint8_t decoded_format = (payload >> 12) & 0xf;
+    if ((record >> 56) != PERSIST_MAGIC || ((record >> 48) & 0xff) != crc8(payload) ||
+        decoded_format >= RULES_FORMAT_COUNT)
+    {
+        return false;
+    }
+    rules_state_t decoded = rules_unpack(payload & 0xfff);
+    if (!rules_valid(&rules_formats[decoded_format], &decoded))
+    {
+        return false;
+    }
+    *seq = payload >> 16;
+    *state = decoded;
+    *format = decoded_format;
+    return true;
+}
+
+void persist_init(const persist_backend_t *backend)
+{
+    persist_backend = *backend;
+    last_seq = 0;
+    last_slot = PERSIST_SLOTS - 1;
+}
+
+bool persist_load(rules_state_t *state, uint8_t *format)
+{
+    bool found = false;
+    for (int slot = 0; slot < PERSIST_SLOTS; slot++)
+    {
+        uint64_t record;
+        uint32_t seq;
+        rules_state_t decoded;
+        uint8_t decoded_format;
+        if (persist_backend.read(persist_backend.ctx, slot, &record) != ESP_OK ||
+            !persist_decode(record, &seq, &decoded, &decoded_format))
+        {
+            continue;
+        }
+        if (!found || seq > last_seq)
+        {
+            found = true;
+            last_seq = seq;
+            last_slot = slot;
+            *state = decoded;
+            *format = decoded_format;
+        }
+    }
+    return found;
+}
+
+esp_err_t persist_store(const rules_state_t *state, uint8_t format)
+{
+    int slot = (last_slot + 1) % PERSIST_SLOTS;
+    esp_err_t err = persist_backend.write(persist_backend.ctx, slot, persist_encode(last_seq + 1, state, format));
+    if (err == ESP_OK)
+    {
+        last_seq++;
+        last_slot = slot;
+    }
+    return err;
+}
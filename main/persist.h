@@ -0,0 +1,62 @@
+#ifndef _PERSIST_H__
+#define _PERSIST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "rules.h"
+
+// Match state that survives a reboot. Each save is one 64-bit record
+// (sequence number, rules_pack() state, format, check bits) written alternately to two
+// slots, so a torn or corrupt write only loses that save: the other slot
+// still holds the one before it.
+
+#define PERSIST_SLOTS 2
+
+// Where records live: NVS on the board (persist_nvs.c), files on the host.
+typedef struct
+{
+    esp_err_t (*read)(void *ctx, int slot, uint64_t *record);  // ESP_ERR_NOT_FOUND if never written
+    esp_err_t (*write)(void *ctx, int slot, uint64_t record); // durable once it returns
+    void *ctx;
+} persist_backend_t;
+
+void persist_init(const persist_backend_t *backend);
+
+// Newest valid state and its RULES_FORMAT_*; false (and nothing written)
+// when there is none.
+bool persist_load(rules_state_t *state, uint8_t *format);
+
+// Writes a state synchronously, in the slot after the newest one.
+esp_err_t persist_store(const rules_state_t *state, uint8_t format);
+
+// Record helpers, exposed for host checks.
+uint64_t persist_encode(uint32_t seq, const rules_state_t *state, uint8_t format);
+bool persist_decode(uint64_t record, uint32_t *seq, rules_state_t *state, uint8_t *format);
+
+// Firmware only (persist_task.c): saves from a low-priority task, coalescing
+// the requests that arrive within PERSIST_COALESCE_MS into one write and
+// never writing more often than every PERSIST_MIN_INTERVAL_MS. A failed write
+// is retried at that interval until it succeeds or a newer state replaces it.
+
+#define PERSIST_COALESCE_MS 500
+#define PERSIST_MIN_INTERVAL_MS 2000
+
+typedef struct
+{
+    uint32_t requests;
+    uint32_t writes;
+    uint32_t errors; // failed writes, retries included
+    uint32_t last_write_us;
+    uint32_t max_write_us;
+} persist_stats_t;
+
+void persist_start(void);
+// Never blocks: only the latest requested state is kept until the task writes it.
+void persist_request(const rules_state_t *state, uint8_t format);
+void persist_get_stats(persist_stats_t *stats);
+
+// NVS backend (persist_nvs.c); nvs_flash_init() must have been called.
+esp_err_t persist_nvs_backend(persist_backend_t *backend);
+
+#endif
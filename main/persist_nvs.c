@@ -0,0 +1,39 @@
+#include "nvs.h"
+#include "persist.h"
+
+#define PERSIST_NVS_NAMESPACE "placar"
+
+static const char *slot_keys[PERSIST_SLOTS] = {"match0", "match1"};
+static nvs_handle_t persist_nvs;
+
+// NVS appends each u64 as a single 32-byte entry, so a save never rewrites a page
+static esp_err_t persist_nvs_read(void *ctx, int slot, uint64_t *record)
+{
+    esp_err_t err = nvs_get_u64(persist_nvs, slot_keys[slot], record);
+    return err == ESP_ERR_NVS_NOT_FOUND ? ESP_ERR_NOT_FOUND : err;
+}
+
+static esp_err_t persist_nvs_write(void *ctx, int slot, uint64_t record)
+{
+    esp_err_t err = nvs_set_u64(persist_nvs, slot_keys[slot], record);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    return nvs_commit(persist_nvs);
+}
+
+esp_err_t persist_nvs_backend(persist_backend_t *backend)
+{
+    esp_err_t err = nvs_open(PERSIST_NVS_NAMESPACE, NVS_READWRITE, &persist_nvs);
+    if (err != ESP_OK)
+    {
+        return err;
+    }
+    *backend = (persist_backend_t){
+        .read = persist_nvs_read,
+        .write = persist_nvs_write,
+        .ctx = NULL,
+    };
+    return ESP_OK;
+}
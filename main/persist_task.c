@@ -0,0 +1,81 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "sched.h"
+#include "sysmem.h"
+#include "persist.h"
+
+#define PERSIST_TASK_STACK 3072
+#define PERSIST_NONE 0xffffffff
+
+static const char *TAG = "persist";
+static TaskHandle_t persist_task_handle = NULL;
+static uint32_t pending = PERSIST_NONE; // format << 12 | rules_pack() of the latest request
+static persist_stats_t stats = {0};
+
+static void persist_task(void *arg)
+{
+    uint32_t written = PERSIST_NONE;
+    while (1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        // Points scored in quick succession end up in one write, but a steady
+        // stream of them still gets saved every PERSIST_MIN_INTERVAL_MS
+        TickType_t first = xTaskGetTickCount();
+        while (xTaskGetTickCount() - first < pdMS_TO_TICKS(PERSIST_MIN_INTERVAL_MS) &&
+               ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(PERSIST_COALESCE_MS)))
+        {
+        }
+
+        uint32_t packed = __atomic_exchange_n(&pending, PERSIST_NONE, __ATOMIC_ACQUIRE);
+        if (packed == PERSIST_NONE || packed == written)
+        {
+            continue;
+        }
+        rules_state_t state = rules_unpack(packed & 0xfff);
+        int64_t start_us = esp_timer_get_time();
+        esp_err_t err = persist_store(&state, packed >> 12);
+        uint32_t took_us = esp_timer_get_time() - start_us;
+        stats.last_write_us = took_us;
+        stats.max_write_us = took_us > stats.max_write_us ? took_us : stats.max_write_us;
+        if (err == ESP_OK)
+        {
+            stats.writes++;
+            written = packed;
+        }
+        else
+        {
+            stats.errors++;
+            ESP_LOGW(TAG, "Store failed: %s, retrying", esp_err_to_name(err));
+            // Back in line unless a newer request took its place; either way the next round stores it
+            uint32_t none = PERSIST_NONE;
+            __atomic_compare_exchange_n(&pending, &none, packed, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+            xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+        }
+
+        // Bounds flash wear: whatever arrives meanwhile waits and is coalesced
+        vTaskDelay(pdMS_TO_TICKS(PERSIST_MIN_INTERVAL_MS));
+    }
+}
+
+void persist_start(void)
+{
+    persist_task_handle = sysmem_task(persist_task, "persist", PERSIST_TASK_STACK, NULL,
+                                      SCHED_PERSIST_PRIORITY, SCHED_CORE(SCHED_CORE_OUTPUT));
+}
+
+void persist_request(const rules_state_t *state, uint8_t format)
+{
+    __atomic_store_n(&pending, (uint32_t)format << 12 | rules_pack(state), __ATOMIC_RELEASE);
+    stats.requests++;
+    if (persist_task_handle)
+    {
+        xTaskNotifyGive(persist_task_handle);
+    }
+}
+
+void persist_get_stats(persist_stats_t *out)
+{
+    *out = stats;
+}
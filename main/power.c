@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "driver/uart.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "render.h"
+#include "power.h"
+
+static const char *TAG = "power";
+
+void power_init(void)
+{
+    esp_pm_config_t config = {
+        .max_freq_mhz = POWER_MAX_CPU_MHZ,
+        .min_freq_mhz = POWER_MIN_CPU_MHZ,
+        .light_sleep_enable = POWER_LIGHT_SLEEP,
+    };
+    esp_err_t err = esp_pm_configure(&config);
+    if (err == ESP_ERR_NOT_SUPPORTED)
+    {
+        ESP_LOGW(TAG, "Power management disabled in sdkconfig, staying at %dMHz", POWER_MAX_CPU_MHZ);
+        return;
+    }
+    ESP_ERROR_CHECK(err);
+    ESP_ERROR_CHECK(uart_set_wakeup_threshold(CONFIG_ESP_CONSOLE_UART_NUM, POWER_UART_WAKE_EDGES));
+    ESP_ERROR_CHECK(esp_sleep_enable_uart_wakeup(CONFIG_ESP_CONSOLE_UART_NUM));
+    ESP_LOGI(TAG, "CPU %d-%dMHz, light sleep %s", POWER_MIN_CPU_MHZ, POWER_MAX_CPU_MHZ,
+             POWER_LIGHT_SLEEP ? "on" : "off");
+}
+
+void power_dump(void)
+{
+    render_stats_t render_stats;
+    render_get_stats(&render_stats);
+    printf("render: idle %lums of %lums up, %lu idle periods\n", (unsigned long)render_stats.idle_ms,
+           (unsigned long)(esp_timer_get_time() / 1000), (unsigned long)render_stats.idle_periods);
+#if CONFIG_PLACAR_POWER_REPORT
+    // Selects CONFIG_PM_PROFILING: after the locks, one line per mode with times entered, time and share
+    printf("locks, then time per power mode since boot:\n");
+#else
+    printf("time per power mode: enable PLACAR_POWER_REPORT in menuconfig\n");
+#endif
+    esp_pm_dump_locks(stdout);
+}
@@ -0,0 +1,28 @@
+#ifndef _POWER_H__
+#define _POWER_H__
+
+// Dynamic frequency scaling and automatic light sleep between points. The chip
+// sleeps whenever FreeRTOS has nothing to run for a few ticks: the firmware's
+// tasks block on events, the render ticks stop once the last frame is shown
+// and an endless animation has settled (see render.h), and the RMT channels
+// are released with the strip data pins held. The buttons wake the chip on
+// the level they wait for (see debounce.h) well within the debounce window;
+// esp_timer callbacks, the console UART and ESP-IDF's own tasks wake it too.
+// What needs a steady clock holds an esp_pm lock: the RMT channels while they
+// transmit, the LEDC buzzer while it plays. Needs CONFIG_PM_ENABLE and
+// CONFIG_FREERTOS_USE_TICKLESS_IDLE.
+
+#define POWER_MAX_CPU_MHZ CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define POWER_MIN_CPU_MHZ 40 // XTAL, the lowest DFS step that keeps esp_timer and the UART running
+#define POWER_LIGHT_SLEEP true
+#define POWER_UART_WAKE_EDGES 3 // console RX edges that wake the chip; those characters are lost
+
+// Call at the end of boot, which runs at full speed
+void power_init(void);
+
+// Idle time of the render task and the esp_pm locks held; with
+// CONFIG_PLACAR_POWER_REPORT (menuconfig, Placar) also the times each power
+// mode was entered and the time spent in it, light sleep included
+void power_dump(void);
+
+#endif
@@ -0,0 +1,328 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "esp_log.h"
+#include "sched.h"
+#include "sysmem.h"
+#include "latency.h"
+#include "eventlog.h"
+#include "render.h"
+
+#define RENDER_QUEUE_LENGTH 16 // power of two
+#define RENDER_TASK_STACK 3072
+#define RENDER_ENDLESS_MS 30000 // an endless animation settles on its target after this, so the ticks can stop
+
+typedef struct
+{
+    frame_t frame;
+    anim_t anim;
+    uint32_t hold_ticks;
+    int64_t event_us;
+} render_item_t;
+
+static const char *TAG = "render";
+
+// Single-producer single-consumer ring: the producer only writes queue_head,
+// the render task only writes queue_tail; both are free-running counters.
+// queue_lock covers the one case where both touch a published item: a full
+// ring, where the producer rewrites the newest item while the render task
+// may be taking the oldest.
+static render_item_t queue[RENDER_QUEUE_LENGTH];
+static uint32_t queue_head = 0;
+static uint32_t queue_tail = 0;
+static portMUX_TYPE queue_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t render_task_handle = NULL;
+static esp_timer_handle_t render_timer = NULL;
+static uint32_t render_fps = 0;
+static render_stats_t stats = {0};
+static int64_t producer_event_us = 0;
+static int64_t pending_event_us = 0; // stamp of the item being presented, until a frame of it lights the strips
+
+// Front is what the strips show, back receives the next frame
+static frame_t buffers[2];
+static frame_t *front = &buffers[0];
+static frame_t *back = &buffers[1];
+
+// Frames of the last stamped event, counted until the next one or idle
+static bool event_open = false;
+static uint32_t event_sent_base = 0;
+static uint32_t event_presented_base = 0;
+
+static uint32_t tick_us = 0; // low half of the time of the last tick
+static int64_t idle_since_us = 0;
+static int64_t idle_total_us = 0;
+
+static void render_tick(void *arg)
+{
+    __atomic_store_n(&tick_us, (uint32_t)esp_timer_get_time(), __ATOMIC_RELAXED);
+    xTaskNotifyGive(render_task_handle);
+}
+
+static void render_event_close(void)
+{
+    if (!event_open)
+    {
+        return;
+    }
+    event_open = false;
+    uint32_t presented = stats.presented - event_presented_base;
+    stats.last_event_frames = framebuffer_frames_sent() - event_sent_base;
+    if (stats.last_event_frames > stats.max_event_frames)
+    {
+        stats.max_event_frames = stats.last_event_frames;
+    }
+    eventlog_write(EVENTLOG_FRAMES, presented < 0xffff ? presented : 0xffff, stats.last_event_frames);
+}
+
+static void render_event_open(void)
+{
+    render_event_close();
+    event_open = true;
+    event_sent_base = framebuffer_frames_sent();
+    event_presented_base = stats.presented;
+}
+
+// Restarts the ticks stopped by render_idle(), from the producer or the render task
+static void render_resume(void)
+{
+    if (esp_timer_is_active(render_timer))
+    {
+        return;
+    }
+    // Only one of two racing callers gets ESP_OK, the other ESP_ERR_INVALID_STATE
+    if (esp_timer_start_periodic(render_timer, 1000000 / render_fps) == ESP_OK)
+    {
+        // First tick now rather than a period later
+        render_tick(NULL);
+    }
+}
+
+// Nothing to animate, hold or present: no ticks and no RMT power lock until render_submit()
+static void render_idle(void)
+{
+    if (esp_timer_stop(render_timer) != ESP_OK)
+    {
+        return; // already idle
+    }
+    render_event_close();
+    framebuffer_release();
+    idle_since_us = esp_timer_get_time();
+    stats.idle_periods++;
+    // A frame queued while the timer was being stopped saw it running and did not restart it
+    if (queue_tail != __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE))
+    {
+        render_resume();
+    }
+}
+
+static void render_present(void)
+{
+    frame_t *shown = back;
+    back = front;
+    front = shown;
+
+    int64_t start = esp_timer_get_time();
+    uint32_t sent = framebuffer_present(front);
+    int64_t end = esp_timer_get_time();
+    uint32_t present_us = end - start;
+    if (present_us > stats.max_present_us)
+    {
+        stats.max_present_us = present_us;
+    }
+    stats.presented++;
+
+    // An animation can start on a frame identical to what is shown (a crossfade
+    // at alpha 0): the photon is the first frame that changes a strip
+    if (pending_event_us && sent)
+    {
+        stats.last_latency_us = end - pending_event_us;
+        if (stats.last_latency_us > stats.max_latency_us)
+        {
+            stats.max_latency_us = stats.last_latency_us;
+        }
+        latency_record(LATENCY_PHOTON, stats.last_latency_us);
+        eventlog_write(EVENTLOG_PHOTON, sent, stats.last_latency_us);
+        pending_event_us = 0;
+    }
+}
+
+static void render_anim_frame(const anim_t *anim, const frame_t *from, const frame_t *to, uint32_t elapsed_ms)
+{
+    uint32_t start = esp_cpu_get_cycle_count();
+    anim_frame(anim, from, to, elapsed_ms, back);
+    uint32_t anim_ns = (esp_cpu_get_cycle_count() - start) * 1000 / esp_rom_get_cpu_ticks_per_us();
+    stats.last_anim_ns = anim_ns;
+    if (anim_ns > stats.max_anim_ns)
+    {
+        stats.max_anim_ns = anim_ns;
+    }
+    stats.anim_frames++;
+    render_present();
+}
+
+static void render_task(void *arg)
+{
+    static frame_t anim_from, anim_to;
+    anim_t anim = {.kind = ANIM_NONE};
+    uint32_t anim_ticks = 0;
+    uint32_t hold_ticks = 0;
+
+    while (1)
+    {
+        uint32_t ticks = ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        latency_record(LATENCY_TICK, (uint32_t)esp_timer_get_time() - __atomic_load_n(&tick_us, __ATOMIC_RELAXED));
+        if (idle_since_us)
+        {
+            idle_total_us += esp_timer_get_time() - idle_since_us;
+            stats.idle_ms = idle_total_us / 1000;
+            idle_since_us = 0;
+        }
+        stats.late_ticks += ticks - 1;
+        uint32_t tail = queue_tail;
+        bool queued = tail != __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE);
+
+        if (anim.kind != ANIM_NONE)
+        {
+            anim_ticks += ticks;
+            uint32_t elapsed_ms = anim_ticks * 1000 / render_fps;
+            if (!anim.duration_ms && queued)
+            {
+                anim.kind = ANIM_NONE;
+                hold_ticks = 0;
+            }
+            else if (anim_done(&anim, elapsed_ms) || (!anim.duration_ms && elapsed_ms >= RENDER_ENDLESS_MS))
+            {
+                anim.kind = ANIM_NONE;
+                *back = anim_to;
+                render_present();
+                continue;
+            }
+            else
+            {
+                render_anim_frame(&anim, &anim_from, &anim_to, elapsed_ms);
+                continue;
+            }
+        }
+        else
+        {
+            hold_ticks = hold_ticks > ticks ? hold_ticks - ticks : 0;
+        }
+
+        if (!hold_ticks && !queued)
+        {
+            render_idle();
+        }
+        if (hold_ticks || !queued)
+        {
+            continue;
+        }
+        render_item_t *item = &queue[tail % RENDER_QUEUE_LENGTH];
+        portENTER_CRITICAL(&queue_lock);
+        hold_ticks = item->hold_ticks;
+        // A stamp whose item never changed the strips has nothing to measure
+        pending_event_us = item->event_us;
+        anim = item->anim;
+        if (anim.kind != ANIM_NONE)
+        {
+            anim_to = item->frame;
+        }
+        else
+        {
+            *back = item->frame;
+        }
+        __atomic_store_n(&queue_tail, tail + 1, __ATOMIC_RELEASE);
+        portEXIT_CRITICAL(&queue_lock);
+        if (pending_event_us)
+        {
+            render_event_open();
+        }
+        if (anim.kind != ANIM_NONE)
+        {
+            anim_ticks = 0;
+            anim_from = *front;
+            render_anim_frame(&anim, &anim_from, &anim_to, 0);
+        }
+        else
+        {
+            render_present();
+        }
+    }
+}
+
+void render_init(uint32_t fps)
+{
+    render_fps = fps;
+    // Starts from what the strips already show, e.g. the first frame drawn at boot
+    framebuffer_snapshot(front);
+    render_task_handle = sysmem_task(render_task, "render", RENDER_TASK_STACK, NULL,
+                                     SCHED_RENDER_PRIORITY, SCHED_CORE(SCHED_CORE_OUTPUT));
+
+    esp_timer_create_args_t timer_args = {
+        .callback = render_tick,
+        .name = "render",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &render_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(render_timer, 1000000 / fps));
+    ESP_LOGI(TAG, "Rendering at %lu fps", (unsigned long)fps);
+}
+
+static void render_fill(render_item_t *item, const anim_t *anim, uint32_t hold_ms)
+{
+    framebuffer_snapshot(&item->frame);
+    item->anim = anim ? *anim : (anim_t){.kind = ANIM_NONE};
+    // A replaced item keeps its stamp: this frame is the first to show its event
+    if (!item->event_us)
+    {
+        item->event_us = producer_event_us;
+    }
+    producer_event_us = 0;
+    // Rounded up: a frame never goes away before its hold time
+    item->hold_ticks = (hold_ms * render_fps + 999) / 1000;
+}
+
+bool render_submit_anim(const anim_t *anim, uint32_t hold_ms)
+{
+    uint32_t head = queue_head;
+    bool full = false;
+    stats.submitted++;
+    if (head - __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE) == RENDER_QUEUE_LENGTH)
+    {
+        // The newest state must reach the strips: it takes the place of the last frame waiting
+        portENTER_CRITICAL(&queue_lock);
+        full = head - __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE) == RENDER_QUEUE_LENGTH;
+        if (full)
+        {
+            render_fill(&queue[(head - 1) % RENDER_QUEUE_LENGTH], anim, hold_ms);
+            stats.replaced++;
+        }
+        portEXIT_CRITICAL(&queue_lock);
+    }
+    if (!full)
+    {
+        render_item_t *item = &queue[head % RENDER_QUEUE_LENGTH];
+        item->event_us = 0;
+        render_fill(item, anim, hold_ms);
+        __atomic_store_n(&queue_head, head + 1, __ATOMIC_RELEASE);
+    }
+    render_resume();
+    return !full;
+}
+
+bool render_submit(uint32_t hold_ms)
+{
+    return render_submit_anim(NULL, hold_ms);
+}
+
+void render_stamp(int64_t event_us)
+{
+    producer_event_us = event_us;
+}
+
+void render_get_stats(render_stats_t *out)
+{
+    *out = stats;
+    out->queued = __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,60 @@
+#ifndef _RENDER_H__
+#define _RENDER_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "framebuffer.h"
+#include "anim.h"
+
+// Once render_init() runs, the render task is the only one calling
+// framebuffer_present(), i.e. it owns both RMT channels. Other tasks stage
+// pixels with framebuffer_set/glyph and hand the result over with
+// render_submit(); frames go out on the ticks of a fixed-rate timer, in order,
+// each staying on the strips at least for its hold time. A frame can come with
+// an animation from anim.h, computed by the render task on every tick. With
+// nothing left to do the timer is stopped and the RMT channels released, so the
+// chip can sleep until the next render_submit().
+
+typedef struct
+{
+    uint32_t submitted;   // frames passed to render_submit()
+    uint32_t replaced;    // frames that took the place of the last one waiting, the queue being full
+    uint32_t presented;   // frames taken from the queue and presented
+    uint32_t late_ticks;  // ticks missed because a present ran past the frame period
+    uint32_t max_present_us;
+    uint32_t anim_frames;   // frames computed by animations
+    uint32_t last_anim_ns;  // compute time of the last animation frame
+    uint32_t max_anim_ns;
+    uint32_t last_latency_us; // from the event stamped with render_stamp() to the first frame of it that changes the strips
+    uint32_t max_latency_us;
+    uint32_t last_event_frames; // strip transmissions for the last score event, see render_stamp()
+    uint32_t max_event_frames;
+    uint32_t idle_ms;      // time with the ticks stopped, nothing to animate, hold or present
+    uint32_t idle_periods; // times the render task went idle
+    uint8_t queued;       // frames waiting right now
+} render_stats_t;
+
+// Starts the render task, presenting at most fps frames per second.
+void render_init(uint32_t fps);
+
+// Queues the staged pixels as the next frame, to be held on the strips for at
+// least hold_ms before the frame after it. Non-blocking, but single producer:
+// call it from one task at a time. When the queue is full the frame replaces
+// the last one waiting, so the newest state is never lost; returns false then.
+bool render_submit(uint32_t hold_ms);
+// Same, with the staged pixels as the target of an animation; the hold time
+// starts when a finite animation ends. An endless one (duration 0) gives way
+// to the next queued frame, or settles on the target after a while when
+// nothing comes, so the render task can go idle.
+bool render_submit_anim(const anim_t *anim, uint32_t hold_ms);
+
+// Stamps the next frame submitted with the esp_timer time of the event it
+// shows; the time until it, or its animation, first changes what the strips
+// show is the render latency. The strip transmissions from that frame until
+// the next stamped one, or until the render task goes idle, are the frames of
+// the event (EVENTLOG_FRAMES).
+void render_stamp(int64_t event_us);
+
+void render_get_stats(render_stats_t *stats);
+
+#endif
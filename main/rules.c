@@ -0,0 +1,158 @@
+#include "rules.h"
+
+// Facts about the scoring team (T) and the other one (O) at the moment of the point
+#define FACT_SET_POINT (1 << 0)     // T is at set_point
+#define FACT_FINAL (1 << 1)         // T is on final
+#define FACT_OTHER_FINAL (1 << 2)   // O is on final
+#define FACT_OTHER_AHEAD (1 << 3)   // O has a tie-break run going
+#define FACT_CLINCH (1 << 4)        // this point completes T's tie-break run
+#define FACT_REACHES_FINAL (1 << 5) // winning this set puts T on final
+
+#define OP_POINT (1 << 0)   // T scores
+#define OP_WIN_SET (1 << 1) // T's score back to 0, one more set for T
+#define OP_DEUCE (1 << 2)   // both scores back to 0
+#define OP_END (1 << 3)     // match over
+
+typedef struct
+{
+    uint8_t mask;  // facts this row looks at
+    uint8_t value; // required value of those facts
+    uint8_t ops;
+} rules_row_t;
+
+// First matching row wins; the last row of each table matches everything.
+static const rules_row_t rules_in_a_row[] = {
+    // T on final
+    {FACT_FINAL | FACT_OTHER_FINAL | FACT_OTHER_AHEAD, FACT_FINAL | FACT_OTHER_FINAL | FACT_OTHER_AHEAD, OP_DEUCE},
+    {FACT_FINAL | FACT_OTHER_FINAL, FACT_FINAL, OP_POINT | OP_END},
+    {FACT_FINAL | FACT_CLINCH, FACT_FINAL | FACT_CLINCH, OP_POINT | OP_END},
+    {FACT_FINAL, FACT_FINAL, OP_POINT},
+    // T wins a set
+    {FACT_SET_POINT | FACT_REACHES_FINAL | FACT_OTHER_FINAL, FACT_SET_POINT | FACT_REACHES_FINAL | FACT_OTHER_FINAL, OP_WIN_SET | OP_DEUCE},
+    {FACT_SET_POINT, FACT_SET_POINT, OP_WIN_SET},
+    // plain point
+    {0, 0, OP_POINT},
+};
+
+static const rules_row_t rules_sudden[] = {
+    {FACT_FINAL, FACT_FINAL, OP_POINT | OP_END},
+    {FACT_SET_POINT | FACT_REACHES_FINAL | FACT_OTHER_FINAL, FACT_SET_POINT | FACT_REACHES_FINAL | FACT_OTHER_FINAL, OP_WIN_SET | OP_DEUCE},
+    {FACT_SET_POINT, FACT_SET_POINT, OP_WIN_SET},
+    {0, 0, OP_POINT},
+};
+
+static const rules_row_t *const rules_tables[RULES_TIEBREAK_COUNT] = {
+    [RULES_TIEBREAK_IN_A_ROW] = rules_in_a_row,
+    [RULES_TIEBREAK_SUDDEN] = rules_sudden,
+};
+
+const rules_config_t rules_formats[RULES_FORMAT_COUNT] = {
+    [RULES_FORMAT_CLASSIC] = {
+        .name = "classic",
+        .set_point = 9,
+        .sets_final = 2,
+        .swap = RULES_SWAP_FIRST_SET,
+        .tiebreak = RULES_TIEBREAK_IN_A_ROW,
+        .tiebreak_points = 2,
+    },
+    [RULES_FORMAT_SHORT] = {
+        .name = "short",
+        .set_point = 6,
+        .sets_final = 2,
+        .swap = RULES_SWAP_FIRST_SET,
+        .tiebreak = RULES_TIEBREAK_IN_A_ROW,
+        .tiebreak_points = 2,
+    },
+    [RULES_FORMAT_SUDDEN] = {
+        .name = "sudden",
+        .set_point = 9,
+        .sets_final = 2,
+        .swap = RULES_SWAP_FIRST_SET,
+        .tiebreak = RULES_TIEBREAK_SUDDEN,
+    },
+    [RULES_FORMAT_LONG] = {
+        .name = "long",
+        .set_point = 9,
+        .sets_final = 3,
+        .swap = RULES_SWAP_EVERY_SET,
+        .tiebreak = RULES_TIEBREAK_IN_A_ROW,
+        .tiebreak_points = 3,
+    },
+};
+
+rules_state_t rules_initial(void)
+{
+    return (rules_state_t){0};
+}
+
+bool rules_valid(const rules_config_t *config, const rules_state_t *state)
+{
+    for (int team = 0; team < RULES_TEAM_COUNT; team++)
+    {
+        if (state->score[team] > config->set_point || state->sets[team] > config->sets_final)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint8_t rules_facts(const rules_config_t *config, const rules_state_t *state, uint8_t team, uint8_t other)
+{
+    uint8_t score = state->score[team], other_score = state->score[other];
+    uint8_t facts = 0;
+    facts |= (score == config->set_point) ? FACT_SET_POINT : 0;
+    facts |= (state->sets[team] >= config->sets_final) ? FACT_FINAL : 0;
+    facts |= (state->sets[other] >= config->sets_final) ? FACT_OTHER_FINAL : 0;
+    facts |= (other_score > 0) ? FACT_OTHER_AHEAD : 0;
+    facts |= (other_score == 0 && score + 1 == config->tiebreak_points) ? FACT_CLINCH : 0;
+    facts |= (state->sets[team] + 1 >= config->sets_final) ? FACT_REACHES_FINAL : 0;
+    return facts;
+}
+
+rules_result_t rules_apply(const rules_config_t *config, rules_state_t state, uint8_t event)
+{
+    uint8_t team = rules_side_team(config, &state, event);
+    uint8_t other = team ^ 1;
+    uint8_t facts = rules_facts(config, &state, team, other);
+
+    const rules_row_t *row = rules_tables[config->tiebreak];
+    while ((facts & row->mask) != row->value)
+    {
+        row++;
+    }
+
+    rules_result_t result = {.state = state, .effects = 0, .team = team};
+    if (row->ops & OP_POINT)
+    {
+        result.state.score[team]++;
+        result.effects |= RULES_EFFECT_POINT;
+    }
+    if (row->ops & OP_WIN_SET)
+    {
+        result.state.score[team] = 0;
+        result.state.sets[team]++;
+        result.effects |= RULES_EFFECT_SET;
+        if (result.state.sets[team] >= config->sets_final)
+        {
+            result.effects |= RULES_EFFECT_FINAL;
+        }
+        // Whether this set moves the teams depends on the format, not on the row
+        if (rules_side_team(config, &result.state, RULES_SIDE_1) != rules_side_team(config, &state, RULES_SIDE_1))
+        {
+            result.effects |= RULES_EFFECT_SWAP;
+        }
+    }
+    if (row->ops & OP_DEUCE)
+    {
+        result.state.score[RULES_TEAM_BLUE] = 0;
+        result.state.score[RULES_TEAM_RED] = 0;
+        result.effects |= RULES_EFFECT_DEUCE;
+    }
+    if (row->ops & OP_END)
+    {
+        result.state = rules_initial();
+        result.effects |= RULES_EFFECT_END;
+    }
+    return result;
+}
@@ -0,0 +1,110 @@
+#ifndef _RULES_H__
+#define _RULES_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Peteca match rules, free of any ESP-IDF dependency so they also build on the host.
+//
+// Blue (scoreboard_team_1) starts on side 1 and red on side 2; depending on
+// the format the teams swap sides after the first set, after every set or
+// never. The point scored at set_point wins the set. A team that wins
+// sets_final sets is on final (white set LED) and its next point ends the
+// match, unless the other team is on final too: then the tie-break of the
+// format applies. RULES_TIEBREAK_IN_A_ROW is "vai a 2", a team must score
+// tiebreak_points in a row and any answer from the other side resets both
+// scores; with RULES_TIEBREAK_SUDDEN the next point wins.
+
+#define RULES_TEAM_BLUE 0
+#define RULES_TEAM_RED 1
+#define RULES_TEAM_COUNT 2
+
+#define RULES_SIDE_1 0 // BTN 1 / led_team_1
+#define RULES_SIDE_2 1 // BTN 2 / led_team_2
+
+#define RULES_EVENT_SIDE_1 RULES_SIDE_1 // point for whoever plays on side 1
+#define RULES_EVENT_SIDE_2 RULES_SIDE_2 // point for whoever plays on side 2
+#define RULES_EVENT_COUNT 2
+
+#define RULES_SCORE_MAX 9 // one digit per side, and 4 bits in rules_pack()
+#define RULES_SETS_MAX 3  // 2 bits in rules_pack()
+
+#define RULES_SWAP_NEVER 0
+#define RULES_SWAP_FIRST_SET 1
+#define RULES_SWAP_EVERY_SET 2
+
+#define RULES_TIEBREAK_IN_A_ROW 0
+#define RULES_TIEBREAK_SUDDEN 1
+#define RULES_TIEBREAK_COUNT 2
+
+// A match format, as data; the engine has one constant row table per tie-break.
+typedef struct
+{
+    const char *name;
+    uint8_t set_point;       // a point scored at this score wins the set, at most RULES_SCORE_MAX
+    uint8_t sets_final;      // sets won to be on final, 1 to RULES_SETS_MAX
+    uint8_t swap;            // RULES_SWAP_*
+    uint8_t tiebreak;        // RULES_TIEBREAK_*
+    uint8_t tiebreak_points; // points in a row, for RULES_TIEBREAK_IN_A_ROW
+} rules_config_t;
+
+#define RULES_FORMAT_CLASSIC 0 // 10 points, final at 2 sets, swap once, vai a 2: the original rules
+#define RULES_FORMAT_SHORT 1   // 7 points
+#define RULES_FORMAT_SUDDEN 2  // classic with sudden death instead of vai a 2
+#define RULES_FORMAT_LONG 3    // final at 3 sets, swap every set, vai a 3
+#define RULES_FORMAT_COUNT 4
+
+extern const rules_config_t rules_formats[RULES_FORMAT_COUNT];
+
+#define RULES_EFFECT_POINT (1 << 0) // scorer's score went up
+#define RULES_EFFECT_SET (1 << 1)   // scorer won a set
+#define RULES_EFFECT_FINAL (1 << 2) // scorer reached final with that set
+#define RULES_EFFECT_SWAP (1 << 3)  // teams changed sides
+#define RULES_EFFECT_DEUCE (1 << 4) // both scores went back to 0 ("vai a 2")
+#define RULES_EFFECT_END (1 << 5)   // match over, state is back to the start
+
+typedef struct
+{
+    uint8_t score[RULES_TEAM_COUNT];
+    uint8_t sets[RULES_TEAM_COUNT]; // green set LED from 1, white from sets_final
+} rules_state_t;
+
+typedef struct
+{
+    rules_state_t state;
+    uint8_t effects; // RULES_EFFECT_*
+    uint8_t team;    // team credited with the event
+} rules_result_t;
+
+rules_state_t rules_initial(void);
+
+// Pure transition function: same format, state and event always give the same result.
+rules_result_t rules_apply(const rules_config_t *config, rules_state_t state, uint8_t event);
+
+// Whether a state is one the format can reach, for states read back from storage.
+bool rules_valid(const rules_config_t *config, const rules_state_t *state);
+
+// Team currently playing on a side.
+static inline uint8_t rules_side_team(const rules_config_t *config, const rules_state_t *state, uint8_t side)
+{
+    uint8_t sets = state->sets[RULES_TEAM_BLUE] + state->sets[RULES_TEAM_RED];
+    bool swapped = config->swap == RULES_SWAP_EVERY_SET ? sets & 1 : config->swap == RULES_SWAP_FIRST_SET && sets > 0;
+    return side ^ swapped;
+}
+
+// 12-bit key of a state: scores in 4 bits each, sets in 2 bits each.
+static inline uint16_t rules_pack(const rules_state_t *state)
+{
+    return state->score[RULES_TEAM_BLUE] | state->score[RULES_TEAM_RED] << 4 |
+           state->sets[RULES_TEAM_BLUE] << 8 | state->sets[RULES_TEAM_RED] << 10;
+}
+
+static inline rules_state_t rules_unpack(uint16_t packed)
+{
+    return (rules_state_t){
+        .score = {packed & 0xf, (packed >> 4) & 0xf},
+        .sets = {(packed >> 8) & 0x3, (packed >> 10) & 0x3},
+    };
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _SCHED_H__
+#define _SCHED_H__
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+// Core and priority of every firmware task. The scoring path (GPIO ISR, input
+// and game tasks) owns the APP core; what only follows it (render task and
+// RMT ISR, buzzer, persist, eventlog) shares the PRO core with app_main, the
+// esp_timer task and the console, so a long redraw or flash write never
+// delays a press. An interrupt is served by the core that installs it: the
+// RMT channels are created by app_main, the GPIO ISR service by the input
+// task.
+//
+// SCHED_PINNED false lets every task run on either core, as before the plan,
+// so the 'jitter' console command can be compared with and without it.
+
+#define SCHED_PINNED true
+#define SCHED_CORE_SCORING 1 // APP_CPU
+#define SCHED_CORE_OUTPUT 0  // PRO_CPU, where app_main and esp_timer run (sdkconfig)
+
+#define SCHED_CORE(core) (SCHED_PINNED ? (core) : tskNO_AFFINITY)
+
+#define SCHED_INPUT_PRIORITY 10   // debounced edges out first, its work is a few microseconds
+#define SCHED_GAME_PRIORITY 8     // gestures and rules
+#define SCHED_RENDER_PRIORITY 5   // 60 fps ticks; on its own core it no longer competes with the two above
+#define SCHED_BUZZER_PRIORITY 2
+#define SCHED_PERSIST_PRIORITY 2  // above the eventlog drain, below everything on the scoring path
+#define SCHED_EVENTLOG_PRIORITY 1 // idle time only
+
+#endif
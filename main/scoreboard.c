@@ -0,0 +1,107 @@
+#include "framebuffer.h"
+#include "render.h"
+#include "scoreboard.h"
+
+#define CHASE_LAP_MS 1200
+#define CHASE_LAPS 2
+#define POINT_FADE_MS 150
+#define START_FADE_MS 300
+#define SWAP_BLINK_MS 400
+#define SWAP_BLINKS 5
+#define FINAL_PULSE_MS 1000
+#define END_BLANK_MS 1000
+#define END_FADE_MS 500
+#define END_HOLD_MS 5400
+#define ANNOUNCE_MS 1500
+
+static rgb team_color(uint8_t team)
+{
+    return team == RULES_TEAM_BLUE ? COLOR_BLUE : COLOR_RED;
+}
+
+static rgb set_color(const rules_config_t *rules, uint8_t sets)
+{
+    if (sets >= rules->sets_final)
+    {
+        return COLOR_WHITE;
+    }
+    return sets ? COLOR_GREEN : NO_COLOR;
+}
+
+void scoreboard_draw(const rules_config_t *rules, const rules_state_t *match)
+{
+    for (int side = RULES_SIDE_1; side <= RULES_SIDE_2; side++)
+    {
+        uint8_t team = rules_side_team(rules, match, side);
+        framebuffer_number(side, match->score[team], team_color(team));
+        framebuffer_set(side, LED_SET_GAME, set_color(rules, match->sets[team]));
+    }
+}
+
+static void end_sequence(void)
+{
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        framebuffer_glyph(strip, glyphs[GLYPH_BLANK], NO_COLOR);
+        framebuffer_set(strip, LED_SET_GAME, NO_COLOR);
+    }
+    render_submit(END_BLANK_MS);
+
+    framebuffer_glyph(STRIP_TEAM_1, glyphs[8], COLOR_PURPLE);
+    framebuffer_glyph(STRIP_TEAM_2, glyphs[8], COLOR_PURPLE);
+    anim_t fade = {.kind = ANIM_CROSSFADE, .strips = ANIM_ALL_STRIPS, .duration_ms = END_FADE_MS};
+    render_submit_anim(&fade, END_HOLD_MS - END_FADE_MS);
+}
+
+void scoreboard_announce(uint8_t number)
+{
+    for (int strip = 0; strip < STRIP_COUNT; strip++)
+    {
+        framebuffer_number(strip, number, COLOR_WHITE);
+        framebuffer_set(strip, LED_SET_GAME, NO_COLOR);
+    }
+    render_submit(ANNOUNCE_MS);
+}
+
+void scoreboard_show(const rules_config_t *rules, const rules_state_t *match, uint8_t effects, uint8_t team)
+{
+    if (effects & RULES_EFFECT_END)
+    {
+        end_sequence();
+    }
+
+    scoreboard_draw(rules, match);
+    bool point_only = (effects & RULES_EFFECT_POINT) && !(effects & RULES_EFFECT_END);
+    anim_t anim = {.kind = ANIM_CROSSFADE, .strips = ANIM_ALL_STRIPS, .duration_ms = point_only ? POINT_FADE_MS : START_FADE_MS};
+    if (effects & RULES_EFFECT_SWAP)
+    {
+        anim = (anim_t){.kind = ANIM_BLINK, .strips = ANIM_ALL_STRIPS, .duration_ms = SWAP_BLINKS * SWAP_BLINK_MS, .period_ms = SWAP_BLINK_MS};
+    }
+    else if (effects & RULES_EFFECT_SET)
+    {
+        // The winner's side: rules_side_team maps sides to teams and back
+        anim = (anim_t){
+            .kind = ANIM_CHASE,
+            .strips = 1u << rules_side_team(rules, match, team),
+            .duration_ms = CHASE_LAPS * CHASE_LAP_MS,
+            .period_ms = CHASE_LAP_MS / ANIM_CHASE_LEDS,
+            .color = COLOR_GREEN,
+        };
+    }
+    render_submit_anim(&anim, 0);
+
+    // Match point: the set LED of a team on final breathes until something changes
+    uint8_t final_sides = 0;
+    for (int side = RULES_SIDE_1; side <= RULES_SIDE_2; side++)
+    {
+        if (match->sets[rules_side_team(rules, match, side)] >= rules->sets_final)
+        {
+            final_sides |= 1u << side;
+        }
+    }
+    if (final_sides)
+    {
+        anim_t pulse = {.kind = ANIM_PULSE, .strips = final_sides, .period_ms = FINAL_PULSE_MS};
+        render_submit_anim(&pulse, 0);
+    }
+}
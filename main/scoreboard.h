@@ -0,0 +1,21 @@
+#ifndef _SCOREBOARD_H__
+#define _SCOREBOARD_H__
+
+#include "rules.h"
+
+// Stages, without committing, the score and set LED of whichever team plays
+// on each side: side 1 on STRIP_TEAM_1, side 2 on STRIP_TEAM_2.
+void scoreboard_draw(const rules_config_t *rules, const rules_state_t *match);
+
+// Queues on the render task the frames that show a match moving to its new
+// state: effects and team come from the rules_result_t (0 at the start of a
+// match). Points crossfade, the side swap blinks, other sets chase around the
+// winner's digits, the end of the match shows a purple 8, and the set LED of
+// a team on final keeps pulsing until the next update.
+void scoreboard_show(const rules_config_t *rules, const rules_state_t *match, uint8_t effects, uint8_t team);
+
+// Queues a white number on both strips for a moment, e.g. the match format
+// just picked, before whatever is shown next.
+void scoreboard_announce(uint8_t number);
+
+#endif
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sysmem.h"
+
+#define SYSMEM_ALIGN 16
+
+typedef struct
+{
+    TaskHandle_t handle;
+    uint32_t stack_bytes;
+} sysmem_task_t;
+
+typedef struct
+{
+    const char *name;
+    uint32_t end_us; // esp_timer time, which starts early in startup
+    int32_t heap_bytes;
+} sysmem_phase_t;
+
+static const char *TAG = "sysmem";
+static uint8_t arena[SYSMEM_STATIC ? SYSMEM_ARENA_BYTES : 1] __attribute__((aligned(SYSMEM_ALIGN)));
+static size_t arena_used = 0;
+static size_t arena_wanted = 0; // what was asked for, including what did not fit
+static sysmem_task_t tasks[SYSMEM_MAX_TASKS];
+static size_t task_count = 0;
+static sysmem_phase_t phases[SYSMEM_MAX_PHASES];
+static size_t phase_count = 0;
+static size_t boot_free = 0;
+static size_t phase_free = 0;
+
+static void *arena_take(size_t size)
+{
+    size = (size + SYSMEM_ALIGN - 1) & ~(size_t)(SYSMEM_ALIGN - 1);
+    arena_wanted += size;
+    if (size > sizeof(arena) - arena_used)
+    {
+        ESP_LOGE(TAG, "Arena full: %u bytes wanted so far, raise SYSMEM_ARENA_BYTES from %u", (unsigned)arena_wanted,
+                 (unsigned)SYSMEM_ARENA_BYTES);
+        return NULL;
+    }
+    void *ptr = &arena[arena_used];
+    arena_used += size;
+    return ptr;
+}
+
+void sysmem_init(void)
+{
+    boot_free = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    phase_free = boot_free;
+}
+
+TaskHandle_t sysmem_task(TaskFunction_t fn, const char *name, uint32_t stack_bytes, void *arg, UBaseType_t priority,
+                         BaseType_t core)
+{
+    TaskHandle_t handle = NULL;
+    if (SYSMEM_STATIC)
+    {
+        // ESP-IDF stacks are counted in bytes, StackType_t is a byte
+        StaticTask_t *tcb = arena_take(sizeof(StaticTask_t));
+        StackType_t *stack = arena_take(stack_bytes);
+        if (tcb && stack)
+        {
+            handle = xTaskCreateStaticPinnedToCore(fn, name, stack_bytes, arg, priority, stack, tcb, core);
+        }
+    }
+    else if (xTaskCreatePinnedToCore(fn, name, stack_bytes, arg, priority, &handle, core) != pdPASS)
+    {
+        handle = NULL;
+    }
+    if (!handle)
+    {
+        ESP_LOGE(TAG, "No memory for task %s", name);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    sysmem_register_task(handle, stack_bytes);
+    return handle;
+}
+
+QueueHandle_t sysmem_queue(UBaseType_t depth, UBaseType_t item_size)
+{
+    QueueHandle_t queue = NULL;
+    if (SYSMEM_STATIC)
+    {
+        StaticQueue_t *control = arena_take(sizeof(StaticQueue_t));
+        uint8_t *storage = arena_take(depth * item_size);
+        if (control && storage)
+        {
+            queue = xQueueCreateStatic(depth, item_size, storage, control);
+        }
+    }
+    else
+    {
+        queue = xQueueCreate(depth, item_size);
+    }
+    if (!queue)
+    {
+        ESP_LOGE(TAG, "No memory for a queue of %u x %u bytes", (unsigned)depth, (unsigned)item_size);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    return queue;
+}
+
+void *sysmem_calloc(size_t count, size_t size)
+{
+    if (!SYSMEM_STATIC)
+    {
+        return calloc(count, size);
+    }
+    if (size && count > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+    // The arena is .bss, already zero, and never handed out twice
+    return arena_take(count * size);
+}
+
+void sysmem_free(void *ptr)
+{
+    if ((uint8_t *)ptr >= arena && (uint8_t *)ptr < arena + sizeof(arena))
+    {
+        return;
+    }
+    free(ptr);
+}
+
+void sysmem_register_task(TaskHandle_t task, uint32_t stack_bytes)
+{
+    if (!task || task_count == SYSMEM_MAX_TASKS)
+    {
+        return;
+    }
+    tasks[task_count++] = (sysmem_task_t){.handle = task, .stack_bytes = stack_bytes};
+}
+
+void sysmem_phase(const char *name)
+{
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    if (phase_count < SYSMEM_MAX_PHASES)
+    {
+        phases[phase_count++] = (sysmem_phase_t){
+            .name = name,
+            .end_us = esp_timer_get_time(),
+            .heap_bytes = (int32_t)(phase_free - free_now),
+        };
+    }
+    phase_free = free_now;
+}
+
+void sysmem_report(void)
+{
+    size_t free_now = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    printf("heap: %u free, %u lowest, %u largest block, %ld used since boot\n", (unsigned)free_now,
+           (unsigned)heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT),
+           (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT), (long)boot_free - (long)free_now);
+    printf("arena: %s, %u of %u bytes used\n", SYSMEM_STATIC ? "static" : "off, tasks on the heap", (unsigned)arena_used,
+           (unsigned)SYSMEM_ARENA_BYTES);
+    printf("%-14s %8s %8s\n", "boot phase", "done ms", "heap");
+    for (size_t i = 0; i < phase_count; i++)
+    {
+        printf("%-14s %8lu %8ld\n", phases[i].name, (unsigned long)(phases[i].end_us / 1000), (long)phases[i].heap_bytes);
+    }
+    printf("%-14s %4s %4s %6s %9s\n", "task", "core", "prio", "stack", "min free");
+    for (size_t i = 0; i < task_count; i++)
+    {
+        BaseType_t core = xTaskGetAffinity(tasks[i].handle);
+        char core_name[4] = "any";
+        if (core != tskNO_AFFINITY)
+        {
+            snprintf(core_name, sizeof(core_name), "%d", (int)core);
+        }
+        printf("%-14s %4s %4u %6lu %9u\n", pcTaskGetName(tasks[i].handle), core_name,
+               (unsigned)uxTaskPriorityGet(tasks[i].handle), (unsigned long)tasks[i].stack_bytes,
+               (unsigned)uxTaskGetStackHighWaterMark(tasks[i].handle));
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef _SYSMEM_H__
+#define _SYSMEM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+
+// Memory of the firmware's own tasks, queues and strip encoder. With
+// SYSMEM_STATIC they are carved at boot out of one array in .bss and never
+// freed, so after boot nothing the firmware creates touches the heap and a
+// long tournament cannot fragment it; ESP-IDF drivers still allocate their
+// own state from the heap while they are installed. Without SYSMEM_STATIC
+// they come from the heap as plain xTaskCreate/xQueueCreate/calloc.
+//
+// Every task is registered, so sysmem_report() can print its stack size and
+// high-water mark next to what each boot phase took from the heap.
+
+#define SYSMEM_STATIC true             // false to allocate from the heap instead
+#define SYSMEM_ARENA_BYTES (32 * 1024) // stacks, TCBs, queues and encoders take about 30KB, see 'mem'
+#define SYSMEM_MAX_TASKS 12
+#define SYSMEM_MAX_PHASES 12
+
+// Records the free heap at boot, before the first phase
+void sysmem_init(void);
+
+// Aborts with a log line saying how much is missing when the arena is full.
+// core is 0, 1 or tskNO_AFFINITY, see sched.h.
+TaskHandle_t sysmem_task(TaskFunction_t fn, const char *name, uint32_t stack_bytes, void *arg, UBaseType_t priority,
+                         BaseType_t core);
+QueueHandle_t sysmem_queue(UBaseType_t depth, UBaseType_t item_size);
+
+// Zeroed memory that lives as long as the firmware; NULL when it does not fit.
+// sysmem_free() only gives back heap memory, arena memory stays taken.
+void *sysmem_calloc(size_t count, size_t size);
+void sysmem_free(void *ptr);
+
+// Tasks created by ESP-IDF components, so the report covers them too; NULL is ignored
+void sysmem_register_task(TaskHandle_t task, uint32_t stack_bytes);
+
+// Ends a boot phase: stamps the time and charges the heap taken since the
+// previous phase, or sysmem_init(), to name. Called from app_main only, like
+// the functions above.
+void sysmem_phase(const char *name);
+
+// Prints the heap, the arena, the boot phases with their times and every task's core, priority and stack headroom
+void sysmem_report(void);
+
+#endif